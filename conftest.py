@@ -19,6 +19,8 @@ limitations under the License.
 
 def pytest_addoption(parser):
     parser.addoption("--test-name", action="store", default="test-name")
+    # pytest_ui_check.py: записать эталоны хешей кадров вместо сверки
+    parser.addoption("--ui-record", action="store_true", default=False)
 
 
 def pytest_generate_tests(metafunc):
@@ -0,0 +1,55 @@
+/**
+ * @file app_console.c
+ * @brief REPL esp_console с командами диагностики
+ */
+
+#include "app_console.h"
+#include "sdkconfig.h"
+
+#if CONFIG_APP_CONSOLE
+
+#include "esp_console.h"
+#include "esp_err.h"
+#include "evtrace.h"
+#include "latency.h"
+#include "perf.h"
+#include "touch_replay.h"
+#include "ui_bench.h"
+
+void app_console_start(void)
+{
+    esp_console_repl_t *repl = NULL;
+    esp_console_repl_config_t repl_config = ESP_CONSOLE_REPL_CONFIG_DEFAULT();
+    repl_config.prompt = "t1>";
+    /* Ниже задачи LVGL: печать статистики не должна задерживать кадр */
+    repl_config.task_priority = 2;
+
+    ESP_ERROR_CHECK(esp_console_register_help_command());
+    evtrace_register_cmd();
+    latency_register_cmd();
+    perf_register_cmd();
+    touch_replay_register_cmd();
+    ui_bench_register_cmd();
+
+#if CONFIG_ESP_CONSOLE_UART_DEFAULT || CONFIG_ESP_CONSOLE_UART_CUSTOM
+    esp_console_dev_uart_config_t hw_config = ESP_CONSOLE_DEV_UART_CONFIG_DEFAULT();
+    ESP_ERROR_CHECK(esp_console_new_repl_uart(&hw_config, &repl_config, &repl));
+#elif CONFIG_ESP_CONSOLE_USB_SERIAL_JTAG
+    esp_console_dev_usb_serial_jtag_config_t hw_config = ESP_CONSOLE_DEV_USB_SERIAL_JTAG_CONFIG_DEFAULT();
+    ESP_ERROR_CHECK(esp_console_new_repl_usb_serial_jtag(&hw_config, &repl_config, &repl));
+#elif CONFIG_ESP_CONSOLE_USB_CDC
+    esp_console_dev_usb_cdc_config_t hw_config = ESP_CONSOLE_DEV_CDC_CONFIG_DEFAULT();
+    ESP_ERROR_CHECK(esp_console_new_repl_usb_cdc(&hw_config, &repl_config, &repl));
+#else
+#error "APP_CONSOLE needs a console port (ESP_CONSOLE_*)"
+#endif
+    ESP_ERROR_CHECK(esp_console_start_repl(repl));
+}
+
+#else
+
+void app_console_start(void)
+{
+}
+
+#endif
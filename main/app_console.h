@@ -0,0 +1,8 @@
+#pragma once
+
+/*
+ * Консоль esp_console на порту ESP_CONSOLE_*: команды диагностики
+ * (bench, evtrace, latency, perf, trace). Команды регистрируются здесь, до запуска REPL.
+ * Без CONFIG_APP_CONSOLE — пустышка.
+ */
+void app_console_start(void);
@@ -1,17 +1,35 @@
+/**
+ * @file display.c
+ * @brief Панель ST7701 по RGB на ESP32-S3: инициализация, буферы и flush_cb
+ */
+
+#include <assert.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include "sdkconfig.h"
 #include "driver/gpio.h"
+#include "esp_attr.h"
 #include "esp_log.h"
 #include "esp_err.h"
 #include "esp_timer.h"
 #include "esp_heap_caps.h"
+#include "esp_cache.h"
 #include "rom/ets_sys.h"
 #include "esp_lcd_panel_ops.h"
 #include "esp_lcd_panel_rgb.h"
 #include "esp_lcd_panel_io.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "display.h"
+#include "display_panel.h"
+#include "evtrace.h"
+#include "latency.h"
+#include "fb_copy.h"
+#include "fb_tiles.h"
+#include "fb_palette.h"
+#include "ui_palette.h"
 
 /* Пины из Arduino-проекта */
 #define LCD_DE_GPIO          18
@@ -157,8 +175,8 @@ static void st7701_init_sequence(void)
     ets_delay_us(120*1000);
 }
 
-#define LCD_H_RES            480
-#define LCD_V_RES            480
+#define LCD_H_RES            DISPLAY_H_RES
+#define LCD_V_RES            DISPLAY_V_RES
 
 /* Тайминги из скетча (Arduino) */
 #define HSYNC_FRONT_PORCH    10
@@ -167,36 +185,266 @@ static void st7701_init_sequence(void)
 #define VSYNC_FRONT_PORCH    10
 #define VSYNC_PULSE_WIDTH    8
 #define VSYNC_BACK_PORCH     20
-#define PCLK_HZ              (8 * 1000 * 1000)  /* Стабильно работает на 8 МГц */
-// #define PCLK_HZ              (16 * 1000 * 1000)  /* Попробовать 16 МГц после исправления clk_src */
-
-/* LVGL таймер период (мс) */
-#define LVGL_TICK_MS         5
+/* Без bounce-буфера стабильно работает только 8 МГц: LCD DMA голодает на PSRAM */
+#define PCLK_HZ              (CONFIG_DISPLAY_PCLK_MHZ * 1000 * 1000)
+
+/* Bounce-буферы во внутренней SRAM, заполняются из фрейм-буфера PSRAM в ISR драйвера */
+#define LCD_BOUNCE_BUFFER_PX (LCD_H_RES * CONFIG_DISPLAY_BOUNCE_BUFFER_LINES)
+_Static_assert(LCD_BOUNCE_BUFFER_PX == 0 || (LCD_H_RES * LCD_V_RES) % (2 * LCD_BOUNCE_BUFFER_PX) == 0,
+               "frame buffer must be an even multiple of the bounce buffer");
+
+#if CONFIG_DISPLAY_RENDER_MODE_DIRECT
+#define LCD_NUM_FBS          2   /* LVGL рисует прямо в задний буфер драйвера */
+#define LCD_NO_FB            0
+#elif CONFIG_DISPLAY_FB_INDEXED
+#define LCD_NUM_FBS          0   /* свой 8-битный буфер, bounce-буферы заполняем сами */
+#define LCD_NO_FB            1
+#else
+#define LCD_NUM_FBS          1
+#define LCD_NO_FB            0
+#endif
+
+#if CONFIG_DISPLAY_RENDER_MODE_PARTIAL
+#if CONFIG_DISPLAY_FLUSH_TILE_SKIP
+/* Грязные области выровнены по рядам тайлов (lvgl_invalidate_area_cb): полоса
+ * меньше ряда не вместит ни одной, строки сверх кратного ряду не используются */
+#define LCD_DRAW_BUF_LINES   (CONFIG_DISPLAY_PARTIAL_BUF_LINES / FB_TILE_SIZE * FB_TILE_SIZE)
+_Static_assert(LCD_DRAW_BUF_LINES >= FB_TILE_SIZE, "partial draw buffer must hold a row of tiles");
+#else
+#define LCD_DRAW_BUF_LINES   CONFIG_DISPLAY_PARTIAL_BUF_LINES
+#endif
+#define LCD_DRAW_BUF_ALIGN   64  /* строка кэша данных, требование DMA к внешней памяти */
+#endif
+
+/* Копирование во фрейм-буфер своим кодом (fb_copy) вместо esp_lcd_panel_draw_bitmap() */
+#if CONFIG_DISPLAY_FLUSH_GDMA || CONFIG_DISPLAY_FLUSH_TILE_SKIP
+#define LCD_FLUSH_VIA_FB_COPY 1
+/* Ширина области кратна 32 px = 64 байта (строка кэша, выравнивание GDMA) и
+ * совпадает с шагом тайлов: экран 480 = 15 x 32 */
+#define LCD_FLUSH_ALIGN_PX   32
+#define LCD_FB_STRIDE        (LCD_H_RES * sizeof(uint16_t))
+/* Прямоугольников на одну полосу после отбрасывания неизменённых тайлов */
+#define LCD_COPY_RECTS_MAX   64
+_Static_assert(LCD_H_RES % LCD_FLUSH_ALIGN_PX == 0 && LCD_V_RES % LCD_FLUSH_ALIGN_PX == 0,
+               "screen must be a multiple of the flush alignment");
+_Static_assert(LCD_FLUSH_ALIGN_PX == FB_TILE_SIZE, "flush alignment must match the tile size");
+#endif
+
+/* Сколько ждать VSYNC, прежде чем считать панель зависшей */
+#define LCD_VSYNC_TIMEOUT_MS 100
+
+/* Ожидание VSYNC: переключение буферов direct-режима или выравнивание начала рендера */
+#if CONFIG_DISPLAY_RENDER_MODE_DIRECT || CONFIG_DISPLAY_RENDER_VSYNC_ALIGN
+#define LCD_USE_VSYNC        1
+#endif
+
+/* Обработчик VSYNC нужен и для отметки вывода кадра на панель */
+#if LCD_USE_VSYNC || CONFIG_LATENCY_STATS
+#define LCD_VSYNC_CB         1
+#endif
 
 static lv_display_t *s_lv_display = NULL;
 static esp_lcd_panel_handle_t s_rgb_panel = NULL;
-static esp_timer_handle_t s_lvgl_tick_timer = NULL;
-static TaskHandle_t s_lvgl_task_handle = NULL;
 static bool s_bl_inited = false;
+#if LCD_USE_VSYNC
+static SemaphoreHandle_t s_vsync_sem = NULL;
+static volatile bool s_vsync_wait = false;
+#endif
+
+#if !CONFIG_DISPLAY_RENDER_MODE_DIRECT && !CONFIG_DISPLAY_FB_INDEXED \
+    && (LCD_FLUSH_VIA_FB_COPY || CONFIG_DISPLAY_RENDER_MODE_PARTIAL)
+/* Flush завершается асинхронно: идущая копия — последняя полоса кадра */
+static volatile bool s_flush_last = false;
+#endif
+
+#if CONFIG_DISPLAY_FB_INDEXED
+static fb_palette_t s_palette;  /* во внутренней RAM: читается из ISR */
+static uint8_t *s_fb8 = NULL;   /* LCD_H_RES * LCD_V_RES индексов в PSRAM */
+#endif
+
+#if LCD_FLUSH_VIA_FB_COPY
+static fb_copy_engine_t s_copy_engine;
+static fb_copy_job_t s_copy_job;
+static fb_rect_t s_copy_rects[LCD_COPY_RECTS_MAX];
+#endif
+
+#if CONFIG_DISPLAY_FLUSH_TILE_SKIP
+static fb_tiles_t s_tiles;
+static uint32_t s_tile_hash[FB_TILES_COUNT(LCD_H_RES, LCD_V_RES)];
+#endif
+
+#if LCD_VSYNC_CB
+/* VSYNC: панель закончила сканировать кадр. Сигналим, только если кто-то ждёт. */
+static bool IRAM_ATTR lcd_on_vsync(esp_lcd_panel_handle_t panel, const esp_lcd_rgb_panel_event_data_t *edata, void *user_ctx)
+{
+    (void)panel;
+    (void)edata;
+    (void)user_ctx;
+    BaseType_t hp_task_woken = pdFALSE;
+    latency_vsync();
+#if LCD_USE_VSYNC
+    if (s_vsync_wait) {
+        s_vsync_wait = false;
+        xSemaphoreGiveFromISR(s_vsync_sem, &hp_task_woken);
+    }
+#endif
+    return hp_task_woken == pdTRUE;
+}
+#endif
+
+#if LCD_USE_VSYNC
 
-static void lvgl_tick_cb(void *arg)
+/* Дождаться следующего VSYNC */
+static void lcd_wait_vsync(void)
 {
-    (void)arg;
-    lv_tick_inc(LVGL_TICK_MS);
+    /* Сбросить «протухший» сигнал от VSYNC, пришедшего после таймаута */
+    (void)xSemaphoreTake(s_vsync_sem, 0);
+    s_vsync_wait = true;
+    if (xSemaphoreTake(s_vsync_sem, pdMS_TO_TICKS(LCD_VSYNC_TIMEOUT_MS)) != pdTRUE) {
+        s_vsync_wait = false;
+        ESP_LOGW("LVGL", "VSYNC timeout");
+    }
 }
+#endif
+
+#if CONFIG_DISPLAY_RENDER_VSYNC_ALIGN
+/* Начинать рендер сразу после VSYNC: кадр копируется во фрейм-буфер, пока
+ * панель сканирует его с начала, и реже попадает под луч развёртки */
+static void lvgl_vsync_align_cb(lv_event_t *e)
+{
+    (void)e;
+    lcd_wait_vsync();
+}
+#endif
+
+#if CONFIG_DISPLAY_RENDER_MODE_DIRECT
+
+/*
+ * Direct-режим: px_map — это один из фрейм-буферов драйвера, LVGL уже нарисовал
+ * в нём все грязные области. Ничего не копируем: на последней области кадра
+ * просим драйвер выводить этот буфер и ждём VSYNC, после которого старый
+ * передний буфер больше не сканируется. Грязные области нового кадра LVGL сам
+ * переносит во второй буфер перед следующим рендером (refr_sync_areas).
+ */
+static void lvgl_flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
+{
+    (void)area;
+    if (!lv_display_flush_is_last(disp)) {
+        lv_display_flush_ready(disp);
+        return;
+    }
 
-/* Отдельная задача для обработки LVGL таймеров */
-static void lvgl_timer_task(void *arg)
+    esp_lcd_panel_draw_bitmap(s_rgb_panel, 0, 0, LCD_H_RES, LCD_V_RES, px_map);
+    latency_flush_done();
+    /* Ждём только после draw_bitmap: VSYNC до переключения не должен освободить буфер */
+    lcd_wait_vsync();
+    lv_display_flush_ready(disp);
+}
+#elif CONFIG_DISPLAY_FB_INDEXED
+/* Bounce-буфер освободился: развернуть следующий кусок индексов через палитру.
+ * pos_px — смещение куска в кадре, кадр лежит в s_fb8 подряд. */
+static bool IRAM_ATTR lcd_on_bounce_empty(esp_lcd_panel_handle_t panel, void *bounce_buf, int pos_px, int len_bytes, void *user_ctx)
 {
-    (void)arg;
-    /* Даем время на полную инициализацию дисплея и LVGL */
-    vTaskDelay(pdMS_TO_TICKS(200));
-    while (1) {
-        lv_timer_handler();
-        vTaskDelay(pdMS_TO_TICKS(5));
+    (void)panel;
+    (void)user_ctx;
+    uint16_t *dst = (uint16_t *)bounce_buf;
+    const uint8_t *src = s_fb8 + pos_px;
+    int n = len_bytes / (int)sizeof(uint16_t);
+    for (int i = 0; i < n; i++) {
+        dst[i] = s_palette.rgb565[src[i]];
     }
+    return false;
 }
 
+/* Полосу RGB565 переводим в индексы прямо во фрейм-буфер; ISR читает его
+ * через тот же кэш, поэтому синхронизация кэша не нужна */
+static void lvgl_flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
+{
+    int32_t w = lv_area_get_width(area);
+    const uint16_t *src = (const uint16_t *)px_map;
+    for (int32_t y = area->y1; y <= area->y2; y++) {
+        fb_palette_encode(&s_palette, s_fb8 + (size_t)y * LCD_H_RES + area->x1, src, (size_t)w);
+        src += w;
+    }
+    if (lv_display_flush_is_last(disp)) {
+        latency_flush_done();
+    }
+    lv_display_flush_ready(disp);
+}
+#elif LCD_FLUSH_VIA_FB_COPY
+static void IRAM_ATTR lcd_copy_done(void *arg)
+{
+#if !CONFIG_DISPLAY_FLUSH_GDMA
+    /* CPU писал через кэш: выгрузить записанные строки в PSRAM для LCD DMA */
+    for (size_t i = 0; i < s_copy_job.rect_cnt; i++) {
+        const fb_rect_t *r = &s_copy_job.rects[i];
+        esp_cache_msync(s_copy_job.fb + r->y1 * LCD_FB_STRIDE, (r->y2 - r->y1 + 1) * LCD_FB_STRIDE,
+                        ESP_CACHE_MSYNC_FLAG_DIR_C2M | ESP_CACHE_MSYNC_FLAG_UNALIGNED);
+    }
+#endif
+    evtrace_instant(EVTRACE_FLUSH_DONE);
+    if (s_flush_last) {
+        latency_flush_done();
+    }
+    lv_display_flush_ready((lv_display_t *)arg);
+}
+
+/* Расширить грязную область до сетки 32 px: строки выровнены под GDMA,
+ * а тайлы чаще покрываются целиком и могут быть пропущены */
+static void lvgl_invalidate_area_cb(lv_event_t *e)
+{
+    lv_area_t *area = (lv_area_t *)lv_event_get_param(e);
+    area->x1 &= ~(LCD_FLUSH_ALIGN_PX - 1);
+    area->x2 |= LCD_FLUSH_ALIGN_PX - 1;
+#if CONFIG_DISPLAY_FLUSH_TILE_SKIP
+    area->y1 &= ~(LCD_FLUSH_ALIGN_PX - 1);
+    area->y2 |= LCD_FLUSH_ALIGN_PX - 1;
+#endif
+}
+
+/* Копирует fb_copy (GDMA или CPU) только изменившиеся тайлы;
+ * lv_display_flush_ready() придёт из lcd_copy_done() */
+static void lvgl_flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
+{
+    s_copy_job.src = px_map;
+    s_copy_job.src_stride = (size_t)lv_area_get_width(area) * sizeof(uint16_t);
+    s_copy_job.area = (fb_rect_t){ area->x1, area->y1, area->x2, area->y2 };
+#if CONFIG_DISPLAY_FLUSH_TILE_SKIP
+    uint32_t t0 = evtrace_now();
+    s_copy_job.rect_cnt = fb_tiles_filter(&s_tiles, px_map, s_copy_job.src_stride, &s_copy_job.area,
+                                          s_copy_rects, LCD_COPY_RECTS_MAX);
+    evtrace_span(EVTRACE_FLUSH_TILES, t0);
+#else
+    s_copy_rects[0] = s_copy_job.area;
+    s_copy_job.rect_cnt = 1;
+#endif
+    s_copy_job.done_arg = disp;
+    s_flush_last = lv_display_flush_is_last(disp);
+    fb_copy_job_start(&s_copy_job);
+}
+#elif CONFIG_DISPLAY_RENDER_MODE_PARTIAL
+/* Полоса скопирована во фрейм-буфер панели: буфер LVGL снова свободен */
+static bool IRAM_ATTR lcd_on_color_trans_done(esp_lcd_panel_handle_t panel, const esp_lcd_rgb_panel_event_data_t *edata, void *user_ctx)
+{
+    (void)panel;
+    (void)edata;
+    (void)user_ctx;
+    evtrace_instant(EVTRACE_FLUSH_DONE);
+    if (s_flush_last) {
+        latency_flush_done();
+    }
+    lv_display_flush_ready(s_lv_display);
+    return false;
+}
+
+/* Готовность сообщает lcd_on_color_trans_done, а не возврат из draw_bitmap:
+ * LVGL тем временем рисует следующую полосу во второй буфер. */
+static void lvgl_flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
+{
+    s_flush_last = lv_display_flush_is_last(disp);
+    esp_lcd_panel_draw_bitmap(s_rgb_panel, area->x1, area->y1, area->x2 + 1, area->y2 + 1, px_map);
+}
+#else
 static void lvgl_flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
 {
     int x1 = area->x1;
@@ -204,10 +452,14 @@ static void lvgl_flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px
     int x2 = area->x2 + 1;
     int y2 = area->y2 + 1;
     esp_lcd_panel_draw_bitmap(s_rgb_panel, x1, y1, x2, y2, px_map);
+    if (lv_display_flush_is_last(disp)) {
+        latency_flush_done();
+    }
     lv_display_flush_ready(disp);
 }
+#endif
 
-void display_init(void)
+lv_display_t *display_panel_init(void)
 {
     /* Подсветка: постоянный HIGH на GPIO */
     gpio_config_t bl_io = {
@@ -231,8 +483,8 @@ void display_init(void)
     esp_lcd_rgb_panel_config_t rgb_config = {
         .data_width = 16, /* R5G6B5 через 5+6+5 линий, фактически 5:6:5 на 16 линий */
         .bits_per_pixel = 16,
-        .num_fbs = 0, /* не выделять внутренние фрейм-буферы */
-        .bounce_buffer_size_px = 0, /* отключить bounce-буфер внутри драйвера */
+        .num_fbs = LCD_NUM_FBS, /* фрейм-буферы драйвера в PSRAM (1 или 2 для direct-режима) */
+        .bounce_buffer_size_px = LCD_BOUNCE_BUFFER_PX, /* 0 = LCD DMA читает PSRAM напрямую */
         .clk_src = LCD_CLK_SRC_PLL160M, /* Как в Arduino примере для стабильной работы на высоких частотах */
         .hsync_gpio_num = LCD_HSYNC_GPIO,
         .vsync_gpio_num = LCD_VSYNC_GPIO,
@@ -258,6 +510,12 @@ void display_init(void)
         },
         .flags = {
             .fb_in_psram = true,   // AAA
+            .no_fb = LCD_NO_FB,
+#if CONFIG_DISPLAY_FLUSH_GDMA
+            /* ISR bounce-буфера сбрасывает прочитанные строки из кэша: пока GDMA
+             * пишет фрейм-буфер, в кэше не остаются его старые строки */
+            .bb_invalidate_cache = true,
+#endif
             .disp_active_low = false,
         },
         /* Порядок B-G-R для правильных цветов (D0..D15 = B0..B4,G0..G5,R0..R4) */
@@ -282,44 +540,110 @@ void display_init(void)
     };
 
     ESP_ERROR_CHECK(esp_lcd_new_rgb_panel(&rgb_config, &s_rgb_panel));
+#if CONFIG_DISPLAY_FB_INDEXED
+    /* Палитра и буфер нужны раньше первого заполнения bounce-буфера */
+    static const uint32_t ui_colors[] = {
+#define UI_COLOR_ENTRY(c) c,
+        UI_PALETTE_COLORS(UI_COLOR_ENTRY)
+#undef UI_COLOR_ENTRY
+    };
+    _Static_assert(sizeof(ui_colors) / sizeof(ui_colors[0]) <= FB_PALETTE_UI_MAX, "too many UI colours for the palette");
+    fb_palette_build(&s_palette, ui_colors, sizeof(ui_colors) / sizeof(ui_colors[0]));
+    s_fb8 = heap_caps_calloc(1, LCD_H_RES * LCD_V_RES, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!s_fb8) {
+        ESP_LOGE("LVGL", "No PSRAM for 8-bit frame buffer");
+        abort();
+    }
+#endif
+#if LCD_USE_VSYNC
+    s_vsync_sem = xSemaphoreCreateBinary();
+    assert(s_vsync_sem);
+#endif
+    /* Все колбэки одним вызовом: повторная регистрация затирает прежние */
+    esp_lcd_rgb_panel_event_callbacks_t cbs = {
+#if LCD_VSYNC_CB
+        .on_vsync = lcd_on_vsync,
+#endif
+#if CONFIG_DISPLAY_FB_INDEXED
+        .on_bounce_empty = lcd_on_bounce_empty,
+#elif CONFIG_DISPLAY_RENDER_MODE_PARTIAL && !LCD_FLUSH_VIA_FB_COPY
+        .on_color_trans_done = lcd_on_color_trans_done,
+#endif
+    };
+    ESP_ERROR_CHECK(esp_lcd_rgb_panel_register_event_callbacks(s_rgb_panel, &cbs, NULL));
     ESP_ERROR_CHECK(esp_lcd_panel_reset(s_rgb_panel));
     ESP_ERROR_CHECK(esp_lcd_panel_init(s_rgb_panel));
     /* На всякий случай включим отображение */
     (void)esp_lcd_panel_disp_on_off(s_rgb_panel, true);
 
-    /* Создаем LVGL дисплей и полный буфер */
-    static lv_color_t *buf1 = NULL;
+#if CONFIG_DISPLAY_RENDER_MODE_DIRECT
+    /* LVGL рисует прямо во фрейм-буферы драйвера, отдельный буфер не нужен */
     size_t buf_pixels = LCD_H_RES * LCD_V_RES;
-    buf1 = heap_caps_malloc(buf_pixels * sizeof(lv_color_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    void *fb0 = NULL;
+    void *fb1 = NULL;
+    ESP_ERROR_CHECK(esp_lcd_rgb_panel_get_frame_buffer(s_rgb_panel, 2, &fb0, &fb1));
+#elif CONFIG_DISPLAY_RENDER_MODE_PARTIAL
+    /* Два DMA-буфера полос во внутренней SRAM, выровненные по строке кэша */
+    size_t draw_buf_bytes = LCD_H_RES * LCD_DRAW_BUF_LINES * sizeof(uint16_t);
+    void *buf1 = heap_caps_aligned_calloc(LCD_DRAW_BUF_ALIGN, 1, draw_buf_bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA);
+    void *buf2 = heap_caps_aligned_calloc(LCD_DRAW_BUF_ALIGN, 1, draw_buf_bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA);
+    if (!buf1 || !buf2) {
+        ESP_LOGE("LVGL", "No internal DMA memory for %u-byte draw buffers", (unsigned)draw_buf_bytes);
+        abort();
+    }
+#else
+    /* Создаем полный буфер LVGL */
+    static uint16_t *buf1 = NULL;
+    size_t buf_pixels = LCD_H_RES * LCD_V_RES;
+    buf1 = heap_caps_malloc(buf_pixels * sizeof(uint16_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
     if (!buf1) {
-        buf1 = heap_caps_malloc(buf_pixels * sizeof(lv_color_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        buf1 = heap_caps_malloc(buf_pixels * sizeof(uint16_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
     }
     if (buf1) {
-        memset(buf1, 0, buf_pixels * sizeof(lv_color_t)); /* Очистка буфера */
+        memset(buf1, 0, buf_pixels * sizeof(uint16_t)); /* Очистка буфера */
     }
+#endif
 
-    lv_init();
     s_lv_display = lv_display_create(LCD_H_RES, LCD_V_RES);
     lv_display_set_color_format(s_lv_display, LV_COLOR_FORMAT_RGB565);
     lv_display_set_flush_cb(s_lv_display, lvgl_flush_cb);
-    lv_display_set_buffers(s_lv_display, buf1, NULL, buf_pixels * sizeof(lv_color_t), LV_DISPLAY_RENDER_MODE_FULL);
-    lv_display_set_antialiasing(s_lv_display, false); /* выключаем сглаживание текста/линий для максимальной резкости */
-    ESP_LOGI("LVGL", "lv_color_t = %d bytes", (int)sizeof(lv_color_t));
-
-    /* Тикер LVGL */
-    const esp_timer_create_args_t tick_args = {
-        .callback = &lvgl_tick_cb,
-        .arg = NULL,
-        .dispatch_method = ESP_TIMER_TASK,
-        .name = "lv_tick"
-    };
-    ESP_ERROR_CHECK(esp_timer_create(&tick_args, &s_lvgl_tick_timer));
-    ESP_ERROR_CHECK(esp_timer_start_periodic(s_lvgl_tick_timer, LVGL_TICK_MS * 1000));
-
-    /* Задача для lv_timer_handler (чтобы не переполнять стек esp_timer) */
-    if (xTaskCreatePinnedToCore(lvgl_timer_task, "lvgl_task", 8192, NULL, 5, &s_lvgl_task_handle, 1) != pdPASS) {
-        ESP_LOGE("LVGL", "Failed to create lvgl_task");
+#if CONFIG_DISPLAY_RENDER_MODE_DIRECT
+    lv_display_set_buffers(s_lv_display, fb0, fb1, buf_pixels * sizeof(uint16_t), LV_DISPLAY_RENDER_MODE_DIRECT);
+#elif CONFIG_DISPLAY_RENDER_MODE_PARTIAL
+    lv_display_set_buffers(s_lv_display, buf1, buf2, draw_buf_bytes, LV_DISPLAY_RENDER_MODE_PARTIAL);
+#else
+    lv_display_set_buffers(s_lv_display, buf1, NULL, buf_pixels * sizeof(uint16_t), LV_DISPLAY_RENDER_MODE_FULL);
+#endif
+
+#if LCD_FLUSH_VIA_FB_COPY
+    void *fb = NULL;
+    ESP_ERROR_CHECK(esp_lcd_rgb_panel_get_frame_buffer(s_rgb_panel, 1, &fb));
+    s_copy_engine = fb_copy_engine_memcpy;
+#if CONFIG_DISPLAY_FLUSH_GDMA
+    /* Дальше фрейм-буфер пишет только DMA: выгрузить из кэша всё, что записал CPU */
+    esp_cache_msync(fb, LCD_V_RES * LCD_FB_STRIDE, ESP_CACHE_MSYNC_FLAG_DIR_C2M | ESP_CACHE_MSYNC_FLAG_INVALIDATE);
+    if (fb_copy_gdma_init(&s_copy_engine, LCD_DRAW_BUF_ALIGN)) {
+        ESP_LOGI("LVGL", "Flush via GDMA async memcpy");
     }
+#endif
+#if CONFIG_DISPLAY_FLUSH_TILE_SKIP
+    fb_tiles_init(&s_tiles, s_tile_hash, LCD_H_RES, LCD_V_RES, sizeof(uint16_t));
+#endif
+    s_copy_job.fb = fb;
+    s_copy_job.fb_stride = LCD_FB_STRIDE;
+    s_copy_job.px_size = sizeof(uint16_t);
+    s_copy_job.rects = s_copy_rects;
+    s_copy_job.engine = &s_copy_engine;
+    s_copy_job.done_cb = lcd_copy_done;
+    lv_display_add_event_cb(s_lv_display, lvgl_invalidate_area_cb, LV_EVENT_INVALIDATE_AREA, NULL);
+#endif
+#if CONFIG_DISPLAY_RENDER_VSYNC_ALIGN
+    /* Раньше обработчика статистики: время рендера считается без ожидания VSYNC */
+    lv_display_add_event_cb(s_lv_display, lvgl_vsync_align_cb, LV_EVENT_RENDER_START, NULL);
+#endif
+    ESP_LOGI("LVGL", "PCLK %d MHz, bounce buffer %d lines", CONFIG_DISPLAY_PCLK_MHZ, CONFIG_DISPLAY_BOUNCE_BUFFER_LINES);
+
+    return s_lv_display;
 }
 
 void display_set_brightness(uint8_t percent)
@@ -329,4 +653,14 @@ void display_set_brightness(uint8_t percent)
     gpio_set_level(LCD_BL_GPIO, percent > 0 ? 1 : 0);
 }
 
+void display_get_tile_stats(uint32_t *skipped, uint32_t *written)
+{
+#if CONFIG_DISPLAY_FLUSH_TILE_SKIP
+    if (skipped) *skipped = s_tiles.skipped;
+    if (written) *written = s_tiles.written;
+#else
+    if (skipped) *skipped = 0;
+    if (written) *written = 0;
+#endif
+}
 
@@ -1,11 +1,72 @@
 #pragma once
 
+#include "sdkconfig.h"
 #include "lvgl.h"
 
-/* Инициализация RGB дисплея ST7701S и привязка к LVGL. */
+/* Инициализация дисплея (RGB-панель ST7701S или кадр в памяти на хосте) и привязка к LVGL. */
 void display_init(void);
 
 /* Установить яркость подсветки 0..100 (%) */
 void display_set_brightness(uint8_t percent);
 
+/* Счётчики тайлов 32x32 с момента запуска: пропущено как неизменённые и
+ * записано во фрейм-буфер. Без CONFIG_DISPLAY_FLUSH_TILE_SKIP — нули. */
+void display_get_tile_stats(uint32_t *skipped, uint32_t *written);
 
+/* Гистограмма времени рендера: по 1 мс, последняя корзина — всё, что дольше */
+#define DISPLAY_RENDER_HIST_BUCKETS 64
+
+/* Счётчики кадров с запуска (или display_reset_frame_stats()). Накопительные:
+ * за интервал — разность двух снимков. */
+typedef struct {
+    uint32_t frames;            /* отрисованных кадров */
+    uint64_t render_us;         /* сумма времени рендера, RENDER_START..RENDER_READY */
+    uint32_t render_us_max;
+    uint64_t flush_us;          /* flush_cb и ожидание flush_ready, большей частью внутри рендера */
+    uint64_t inv_px;            /* сумма площадей перерисованных областей */
+    uint32_t render_hist[DISPLAY_RENDER_HIST_BUCKETS];
+} display_frame_stats_t;
+
+void display_get_frame_stats(display_frame_stats_t *stats);
+void display_reset_frame_stats(void);
+
+/* Потоки рисования LVGL: по одному на ядро, поток i — на ядре i */
+#define DISPLAY_DRAW_CORES 2
+
+/* Время работы потока рисования каждого ядра, мкс (run-time stats FreeRTOS,
+ * накопительно, переполнение uint32 снимает беззнаковая разность).
+ * false — потоки не привязаны к ядрам (хост, одно ядро) или счётчики выключены. */
+bool display_get_draw_time(uint32_t us[DISPLAY_DRAW_CORES]);
+
+/* Таймаут display_lock(): ждать без ограничения */
+#define DISPLAY_LOCK_FOREVER UINT32_MAX
+
+/*
+ * Доступ к LVGL из любой задачи. Рекурсивный мьютекс: задача LVGL держит
+ * его на время lv_timer_handler(), остальные берут перед вызовами lv_*.
+ * Возвращает false, если не удалось захватить за timeout_ms.
+ */
+bool display_lock(uint32_t timeout_ms);
+void display_unlock(void);
+
+typedef void (*display_async_cb_t)(void *arg);
+
+/*
+ * Выполнить cb(arg) в задаче LVGL под блокировкой перед очередным
+ * lv_timer_handler(). Не ждёт рендер; false — очередь заполнена.
+ */
+bool display_async_call(display_async_cb_t cb, void *arg);
+
+/*
+ * Разбудить задачу LVGL до истечения её сна: новый ввод или изменения UI,
+ * сделанные из другой задачи. Из ISR не вызывать.
+ */
+void display_wake(void);
+
+#if CONFIG_IDF_TARGET_LINUX
+/* Сборка под Linux: записать текущий кадр в PNG. Берёт display_lock(). */
+bool display_save_png(const char *path);
+
+/* Сборка под Linux: FNV-1a 32 по текущему кадру RGB565. Берёт display_lock(). */
+uint32_t display_frame_hash(void);
+#endif
@@ -0,0 +1,203 @@
+/**
+ * @file display_host.c
+ * @brief Панель сборки под Linux: кадр RGB565 в памяти и PNG-снимки
+ *
+ * Вместо ST7701 — фрейм-буфер 480x480 в памяти процесса. LVGL рисует в
+ * режиме из menuconfig: direct — прямо в него, full и partial — в свой
+ * буфер, flush копирует область. Рендер тот же, что на устройстве, нет
+ * только вывода на панель.
+ *
+ * Снимки задаются окружением:
+ *   T1_PNG_AT_MS=500,1200  кадр в <T1_PNG_DIR>/frame_<мс>.png через столько
+ *                          мс после создания дисплея
+ *   T1_PNG_DIR=out         каталог снимков, по умолчанию текущий
+ *   T1_RUN_MS=3000         через столько мс записать frame_end.png и выйти
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sdkconfig.h"
+#include "esp_log.h"
+#include "esp_err.h"
+#include "esp_timer.h"
+#include "display.h"
+#include "display_panel.h"
+#include "fb_png.h"
+
+static const char *TAG = "HOST_DISPLAY";
+
+#define HOST_PNG_TIMES_MAX  32
+#define HOST_PATH_MAX       256
+#define HOST_BUF_ALIGN      64
+
+static uint16_t s_fb[DISPLAY_H_RES * DISPLAY_V_RES] __attribute__((aligned(HOST_BUF_ALIGN)));
+static lv_display_t *s_lv_display = NULL;
+
+static uint32_t s_png_at_ms[HOST_PNG_TIMES_MAX];
+static size_t s_png_cnt = 0;
+static size_t s_png_next = 0;
+static esp_timer_handle_t s_png_timer = NULL;
+static esp_timer_handle_t s_exit_timer = NULL;
+static int64_t s_t0_us;
+
+static void lvgl_flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
+{
+    /* В direct-режиме LVGL уже нарисовал в s_fb */
+    if ((uint16_t *)px_map != s_fb) {
+        int32_t w = lv_area_get_width(area);
+        const uint16_t *src = (const uint16_t *)px_map;
+        for (int32_t y = area->y1; y <= area->y2; y++) {
+            memcpy(&s_fb[(size_t)y * DISPLAY_H_RES + area->x1], src, (size_t)w * sizeof(uint16_t));
+            src += w;
+        }
+    }
+    lv_display_flush_ready(disp);
+}
+
+static const char *png_dir(void)
+{
+    const char *dir = getenv("T1_PNG_DIR");
+    return dir && dir[0] ? dir : ".";
+}
+
+static void save_named(const char *name)
+{
+    char path[HOST_PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%s", png_dir(), name);
+    if (display_save_png(path)) {
+        ESP_LOGI(TAG, "Frame saved to %s", path);
+    }
+}
+
+static void png_timer_start(void)
+{
+    if (s_png_next >= s_png_cnt) return;
+    int64_t due_us = s_t0_us + (int64_t)s_png_at_ms[s_png_next] * 1000;
+    int64_t wait_us = due_us - esp_timer_get_time();
+    ESP_ERROR_CHECK(esp_timer_start_once(s_png_timer, wait_us > 0 ? (uint64_t)wait_us : 0));
+}
+
+static void png_timer_cb(void *arg)
+{
+    (void)arg;
+    char name[32];
+    snprintf(name, sizeof(name), "frame_%u.png", (unsigned)s_png_at_ms[s_png_next]);
+    save_named(name);
+    s_png_next++;
+    png_timer_start();
+}
+
+static void exit_timer_cb(void *arg)
+{
+    (void)arg;
+    save_named("frame_end.png");
+    fflush(stdout);
+    exit(0);
+}
+
+static int cmp_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+/* «500,1200,3000» -> s_png_at_ms по возрастанию */
+static void parse_png_times(const char *list)
+{
+    while (list && *list && s_png_cnt < HOST_PNG_TIMES_MAX) {
+        char *end;
+        unsigned long ms = strtoul(list, &end, 10);
+        if (end == list) break;
+        s_png_at_ms[s_png_cnt++] = (uint32_t)ms;
+        list = *end == ',' ? end + 1 : end;
+    }
+    qsort(s_png_at_ms, s_png_cnt, sizeof(s_png_at_ms[0]), cmp_u32);
+}
+
+lv_display_t *display_panel_init(void)
+{
+    s_lv_display = lv_display_create(DISPLAY_H_RES, DISPLAY_V_RES);
+    lv_display_set_color_format(s_lv_display, LV_COLOR_FORMAT_RGB565);
+    lv_display_set_flush_cb(s_lv_display, lvgl_flush_cb);
+#if CONFIG_DISPLAY_RENDER_MODE_DIRECT
+    lv_display_set_buffers(s_lv_display, s_fb, NULL, sizeof(s_fb), LV_DISPLAY_RENDER_MODE_DIRECT);
+#elif CONFIG_DISPLAY_RENDER_MODE_PARTIAL
+    size_t draw_buf_bytes = DISPLAY_H_RES * CONFIG_DISPLAY_PARTIAL_BUF_LINES * sizeof(uint16_t);
+    void *buf1 = aligned_alloc(HOST_BUF_ALIGN, draw_buf_bytes);
+    void *buf2 = aligned_alloc(HOST_BUF_ALIGN, draw_buf_bytes);
+    if (!buf1 || !buf2) abort();
+    lv_display_set_buffers(s_lv_display, buf1, buf2, draw_buf_bytes, LV_DISPLAY_RENDER_MODE_PARTIAL);
+#else
+    void *buf1 = aligned_alloc(HOST_BUF_ALIGN, sizeof(s_fb));
+    if (!buf1) abort();
+    lv_display_set_buffers(s_lv_display, buf1, NULL, sizeof(s_fb), LV_DISPLAY_RENDER_MODE_FULL);
+#endif
+
+    s_t0_us = esp_timer_get_time();
+    parse_png_times(getenv("T1_PNG_AT_MS"));
+    if (s_png_cnt > 0) {
+        const esp_timer_create_args_t args = {
+            .callback = &png_timer_cb,
+            .dispatch_method = ESP_TIMER_TASK,
+            .name = "host_png",
+        };
+        ESP_ERROR_CHECK(esp_timer_create(&args, &s_png_timer));
+        png_timer_start();
+    }
+    const char *run_ms = getenv("T1_RUN_MS");
+    if (run_ms && run_ms[0]) {
+        const esp_timer_create_args_t args = {
+            .callback = &exit_timer_cb,
+            .dispatch_method = ESP_TIMER_TASK,
+            .name = "host_exit",
+        };
+        ESP_ERROR_CHECK(esp_timer_create(&args, &s_exit_timer));
+        ESP_ERROR_CHECK(esp_timer_start_once(s_exit_timer, (uint64_t)strtoul(run_ms, NULL, 10) * 1000));
+    }
+    ESP_LOGI(TAG, "In-memory %dx%d RGB565 framebuffer, %u PNG snapshot(s) scheduled",
+             DISPLAY_H_RES, DISPLAY_V_RES, (unsigned)s_png_cnt);
+    return s_lv_display;
+}
+
+bool display_save_png(const char *path)
+{
+    FILE *f = fopen(path, "wb");
+    if (f == NULL) {
+        ESP_LOGE(TAG, "Cannot open %s", path);
+        return false;
+    }
+    /* Под блокировкой LVGL кадр не рисуется: снимок целый */
+    display_lock(DISPLAY_LOCK_FOREVER);
+    bool ok = fb_png_write(f, s_fb, DISPLAY_H_RES, DISPLAY_V_RES, DISPLAY_H_RES);
+    display_unlock();
+    ok = fclose(f) == 0 && ok;
+    if (!ok) {
+        ESP_LOGE(TAG, "Failed to write %s", path);
+    }
+    return ok;
+}
+
+uint32_t display_frame_hash(void)
+{
+    const uint8_t *p = (const uint8_t *)s_fb;
+    uint32_t h = 2166136261u;
+    display_lock(DISPLAY_LOCK_FOREVER);
+    for (size_t i = 0; i < sizeof(s_fb); i++) {
+        h = (h ^ p[i]) * 16777619u;
+    }
+    display_unlock();
+    return h;
+}
+
+void display_set_brightness(uint8_t percent)
+{
+    (void)percent; /* подсветки нет */
+}
+
+void display_get_tile_stats(uint32_t *skipped, uint32_t *written)
+{
+    if (skipped) *skipped = 0;
+    if (written) *written = 0;
+}
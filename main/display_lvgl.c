@@ -0,0 +1,313 @@
+/**
+ * @file display_lvgl.c
+ * @brief Задача LVGL, блокировка, отложенные вызовы и счётчики кадров
+ *
+ * От железа не зависит: дисплей с буферами и flush_cb создаёт панель
+ * (display_panel.h), здесь — всё, что над ней.
+ */
+
+#include <assert.h>
+#include <string.h>
+#include "sdkconfig.h"
+#include "esp_log.h"
+#include "esp_err.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include "display.h"
+#include "display_panel.h"
+#include "display/lv_display_private.h"
+#include "evtrace.h"
+#include "latency.h"
+
+/* Отложенных вызовов display_async_call() между проходами lv_timer_handler() */
+#define LVGL_ASYNC_QUEUE_LEN 16
+
+#if CONFIG_FREERTOS_UNICORE
+#define LVGL_TASK_CORE       0
+#else
+#define LVGL_TASK_CORE       CONFIG_DISPLAY_LVGL_TASK_CORE
+#endif
+
+static lv_display_t *s_lv_display = NULL;
+static TaskHandle_t s_lvgl_task_handle = NULL;
+static SemaphoreHandle_t s_lvgl_mutex = NULL;
+static QueueHandle_t s_async_queue = NULL;
+
+typedef struct {
+    display_async_cb_t cb;
+    void *arg;
+} lvgl_async_msg_t;
+
+static esp_timer_handle_t s_lvgl_wake_timer = NULL;
+
+#if CONFIG_LV_OS_FREERTOS && !CONFIG_FREERTOS_UNICORE && !CONFIG_IDF_TARGET_LINUX
+#define LVGL_PIN_DRAW_THREADS 1
+#endif
+
+/* Потоки рисования LVGL, привязанные к ядрам в lv_init(): [ядро] */
+static volatile bool s_draw_pin = false;
+static uint32_t s_draw_thread_cnt;
+static TaskHandle_t s_draw_threads[DISPLAY_DRAW_CORES];
+
+/* Счётчики кадров: пишет задача LVGL, читают остальные */
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static display_frame_stats_t s_frame_stats;
+static int64_t s_render_start_us;
+static int64_t s_flush_start_us;
+static uint32_t s_render_start_ev;
+static uint32_t s_flush_start_ev;
+
+#if !CONFIG_IDF_TARGET_LINUX
+/*
+ * Потоки рисования LVGL создаёт xTaskCreate() без привязки к ядру, а ядро
+ * FreeRTOS в IDF не меняет привязку после создания. Линкер подменяет
+ * xTaskCreatePinnedToCore (--wrap в main/CMakeLists.txt): пока идёт
+ * lv_init(), задачи без привязки получают ядра 0, 1, ... по очереди.
+ */
+BaseType_t __real_xTaskCreatePinnedToCore(TaskFunction_t fn, const char *const name,
+                                          const configSTACK_DEPTH_TYPE stack, void *const arg,
+                                          UBaseType_t prio, TaskHandle_t *const handle, const BaseType_t core);
+
+BaseType_t __wrap_xTaskCreatePinnedToCore(TaskFunction_t fn, const char *const name,
+                                          const configSTACK_DEPTH_TYPE stack, void *const arg,
+                                          UBaseType_t prio, TaskHandle_t *const handle, const BaseType_t core)
+{
+    if (!s_draw_pin || core != tskNO_AFFINITY || s_draw_thread_cnt >= DISPLAY_DRAW_CORES) {
+        return __real_xTaskCreatePinnedToCore(fn, name, stack, arg, prio, handle, core);
+    }
+    BaseType_t pin_core = (BaseType_t)s_draw_thread_cnt;
+    TaskHandle_t task = NULL;
+    BaseType_t ret = __real_xTaskCreatePinnedToCore(fn, name, stack, arg, prio, &task, pin_core);
+    if (ret == pdPASS) {
+        s_draw_threads[s_draw_thread_cnt++] = task;
+        ESP_LOGI("LVGL", "draw thread '%s' pinned to core %d", name, (int)pin_core);
+    }
+    if (handle) {
+        *handle = task;
+    }
+    return ret;
+}
+#endif
+
+/* Время LVGL берёт прямо из esp_timer: без периодического тикера, который
+ * будил бы CPU и в простое, и с точностью до миллисекунды */
+static uint32_t lvgl_tick_get_cb(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+static void lvgl_wake_timer_cb(void *arg)
+{
+    (void)arg;
+    display_wake();
+}
+
+/*
+ * Задача LVGL спит ровно столько, сколько вернул lv_timer_handler(): срок
+ * отмеряет one-shot esp_timer с точностью до микросекунд, а не тик FreeRTOS
+ * (10 мс при CONFIG_FREERTOS_HZ=100). Раньше срока будит display_wake():
+ * ввод, отложенный вызов, инвалидация из другой задачи. Если таймеров нет,
+ * задача спит до такого события.
+ */
+static void lvgl_timer_task(void *arg)
+{
+    (void)arg;
+    lvgl_async_msg_t msg;
+    while (1) {
+        display_lock(DISPLAY_LOCK_FOREVER);
+        while (xQueueReceive(s_async_queue, &msg, 0) == pdTRUE) {
+            uint32_t t0 = evtrace_now();
+            msg.cb(msg.arg);
+            evtrace_span(EVTRACE_ASYNC_CALL, t0);
+        }
+        uint32_t t0 = evtrace_now();
+        uint32_t wait_ms = lv_timer_handler();
+        evtrace_span(EVTRACE_LV_TIMER, t0);
+        display_unlock();
+
+        if (wait_ms == 0) {
+            /* Таймер уже готов, но задачи того же приоритета на этом ядре
+             * не должны голодать */
+            taskYIELD();
+            continue;
+        }
+        (void)esp_timer_stop(s_lvgl_wake_timer);
+        if (wait_ms != LV_NO_TIMER_READY) {
+            ESP_ERROR_CHECK(esp_timer_start_once(s_lvgl_wake_timer, (uint64_t)wait_ms * 1000));
+        }
+        (void)ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+}
+
+/* Область помечена к перерисовке вне задачи LVGL (под display_lock) —
+ * разбудить её, чтобы не ждать истечения текущего сна */
+static void lvgl_invalidate_wake_cb(lv_event_t *e)
+{
+    (void)e;
+    if (xTaskGetCurrentTaskHandle() != s_lvgl_task_handle) {
+        display_wake();
+    }
+}
+
+#if CONFIG_LATENCY_STATS
+/* Отсчёты тача, изменившие UI до этого момента, попадут в этот кадр */
+static void lvgl_latency_render_cb(lv_event_t *e)
+{
+    (void)e;
+    latency_render_start();
+}
+#endif
+
+/* Время рендера и площадь кадра. Области к RENDER_START уже объединены,
+ * поглощённые помечены inv_area_joined. */
+static void lvgl_render_event_cb(lv_event_t *e)
+{
+    int64_t now = esp_timer_get_time();
+    if (lv_event_get_code(e) == LV_EVENT_RENDER_START) {
+        lv_display_t *disp = (lv_display_t *)lv_event_get_target(e);
+        uint32_t px = 0;
+        for (uint32_t i = 0; i < disp->inv_p; i++) {
+            if (!disp->inv_area_joined[i]) {
+                px += lv_area_get_size(&disp->inv_areas[i]);
+            }
+        }
+        s_render_start_us = now;
+        s_render_start_ev = evtrace_now();
+        portENTER_CRITICAL(&s_stats_lock);
+        s_frame_stats.inv_px += px;
+        portEXIT_CRITICAL(&s_stats_lock);
+    } else {
+        evtrace_span(EVTRACE_RENDER, s_render_start_ev);
+        uint32_t us = (uint32_t)(now - s_render_start_us);
+        uint32_t ms = us / 1000;
+        portENTER_CRITICAL(&s_stats_lock);
+        s_frame_stats.frames++;
+        s_frame_stats.render_us += us;
+        if (us > s_frame_stats.render_us_max) s_frame_stats.render_us_max = us;
+        s_frame_stats.render_hist[ms < DISPLAY_RENDER_HIST_BUCKETS ? ms : DISPLAY_RENDER_HIST_BUCKETS - 1]++;
+        portEXIT_CRITICAL(&s_stats_lock);
+    }
+}
+
+/* Время задачи LVGL на вывод: внутри flush_cb и в ожидании flush_ready
+ * (асинхронная копия, VSYNC direct-режима) */
+static void lvgl_flush_event_cb(lv_event_t *e)
+{
+    int64_t now = esp_timer_get_time();
+    lv_event_code_t code = lv_event_get_code(e);
+    if (code == LV_EVENT_FLUSH_START || code == LV_EVENT_FLUSH_WAIT_START) {
+        s_flush_start_us = now;
+        s_flush_start_ev = evtrace_now();
+    } else {
+        evtrace_span(code == LV_EVENT_FLUSH_FINISH ? EVTRACE_FLUSH : EVTRACE_FLUSH_WAIT, s_flush_start_ev);
+        portENTER_CRITICAL(&s_stats_lock);
+        s_frame_stats.flush_us += (uint64_t)(now - s_flush_start_us);
+        portEXIT_CRITICAL(&s_stats_lock);
+    }
+}
+
+void display_init(void)
+{
+    s_lvgl_mutex = xSemaphoreCreateRecursiveMutex();
+    s_async_queue = xQueueCreate(LVGL_ASYNC_QUEUE_LEN, sizeof(lvgl_async_msg_t));
+    assert(s_lvgl_mutex && s_async_queue);
+
+#if LVGL_PIN_DRAW_THREADS
+    s_draw_pin = true;
+#endif
+    lv_init();
+    s_draw_pin = false;
+    lv_tick_set_cb(lvgl_tick_get_cb);
+    if (s_draw_thread_cnt && s_draw_thread_cnt != DISPLAY_DRAW_CORES) {
+        ESP_LOGW("LVGL", "%u draw threads pinned, expected %d", (unsigned)s_draw_thread_cnt, DISPLAY_DRAW_CORES);
+    }
+    /* Обработчики панели регистрируются раньше: ожидание VSYNC не входит во время рендера */
+    s_lv_display = display_panel_init();
+    lv_display_add_event_cb(s_lv_display, lvgl_invalidate_wake_cb, LV_EVENT_INVALIDATE_AREA, NULL);
+#if CONFIG_LATENCY_STATS
+    lv_display_add_event_cb(s_lv_display, lvgl_latency_render_cb, LV_EVENT_RENDER_START, NULL);
+#endif
+    lv_display_add_event_cb(s_lv_display, lvgl_render_event_cb, LV_EVENT_RENDER_START, NULL);
+    lv_display_add_event_cb(s_lv_display, lvgl_render_event_cb, LV_EVENT_RENDER_READY, NULL);
+    lv_display_add_event_cb(s_lv_display, lvgl_flush_event_cb, LV_EVENT_FLUSH_START, NULL);
+    lv_display_add_event_cb(s_lv_display, lvgl_flush_event_cb, LV_EVENT_FLUSH_FINISH, NULL);
+    lv_display_add_event_cb(s_lv_display, lvgl_flush_event_cb, LV_EVENT_FLUSH_WAIT_START, NULL);
+    lv_display_add_event_cb(s_lv_display, lvgl_flush_event_cb, LV_EVENT_FLUSH_WAIT_FINISH, NULL);
+    lv_display_set_antialiasing(s_lv_display, false); /* выключаем сглаживание текста/линий для максимальной резкости */
+    ESP_LOGI("LVGL", "lv_color_t = %d bytes", (int)sizeof(lv_color_t));
+
+    const esp_timer_create_args_t wake_args = {
+        .callback = &lvgl_wake_timer_cb,
+        .arg = NULL,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "lv_wake"
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&wake_args, &s_lvgl_wake_timer));
+
+    /* Задача для lv_timer_handler (чтобы не переполнять стек esp_timer) */
+    if (xTaskCreatePinnedToCore(lvgl_timer_task, "lvgl_task", 8192, NULL, CONFIG_DISPLAY_LVGL_TASK_PRIO,
+                                &s_lvgl_task_handle, LVGL_TASK_CORE) != pdPASS) {
+        ESP_LOGE("LVGL", "Failed to create lvgl_task");
+    }
+}
+
+bool display_lock(uint32_t timeout_ms)
+{
+    TickType_t ticks = (timeout_ms == DISPLAY_LOCK_FOREVER) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+    return xSemaphoreTakeRecursive(s_lvgl_mutex, ticks) == pdTRUE;
+}
+
+void display_unlock(void)
+{
+    xSemaphoreGiveRecursive(s_lvgl_mutex);
+}
+
+bool display_async_call(display_async_cb_t cb, void *arg)
+{
+    lvgl_async_msg_t msg = { .cb = cb, .arg = arg };
+    if (xQueueSend(s_async_queue, &msg, 0) != pdTRUE) {
+        return false;
+    }
+    display_wake();
+    return true;
+}
+
+void display_wake(void)
+{
+    if (s_lvgl_task_handle) {
+        xTaskNotifyGive(s_lvgl_task_handle);
+    }
+}
+
+void display_get_frame_stats(display_frame_stats_t *stats)
+{
+    portENTER_CRITICAL(&s_stats_lock);
+    *stats = s_frame_stats;
+    portEXIT_CRITICAL(&s_stats_lock);
+}
+
+bool display_get_draw_time(uint32_t us[DISPLAY_DRAW_CORES])
+{
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+    if (s_draw_thread_cnt != DISPLAY_DRAW_CORES) {
+        return false;
+    }
+    for (int core = 0; core < DISPLAY_DRAW_CORES; core++) {
+        us[core] = (uint32_t)ulTaskGetRunTimeCounter(s_draw_threads[core]);
+    }
+    return true;
+#else
+    (void)us;
+    return false;
+#endif
+}
+
+void display_reset_frame_stats(void)
+{
+    portENTER_CRITICAL(&s_stats_lock);
+    memset(&s_frame_stats, 0, sizeof(s_frame_stats));
+    portEXIT_CRITICAL(&s_stats_lock);
+}
@@ -0,0 +1,23 @@
+/**
+ * @file display_panel.h
+ * @brief Панель под display_lvgl.c: RGB-панель ST7701 или фрейм-буфер в памяти
+ *
+ * display_lvgl.c держит то, что от железа не зависит: задачу LVGL,
+ * блокировку, отложенные вызовы, счётчики кадров. Панель создаёт
+ * lv_display с буферами и flush_cb, сама отмечает latency_flush_done() и
+ * реализует display_set_brightness() и display_get_tile_stats().
+ * display.c — ST7701 на ESP32-S3, display_host.c — сборка под Linux.
+ */
+
+#pragma once
+
+#include "lvgl.h"
+
+#define DISPLAY_H_RES   480
+#define DISPLAY_V_RES   480
+
+/*
+ * Вызывается после lv_init(), до запуска задачи LVGL. Обработчики событий
+ * дисплея, добавленные здесь, срабатывают раньше общих из display_lvgl.c.
+ */
+lv_display_t *display_panel_init(void);
@@ -0,0 +1,242 @@
+/**
+ * @file draw_simd.c
+ * @brief Построчная обвязка вокруг PIE-циклов: голова и хвост строки на C
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "draw_simd.h"
+
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
+
+#if CONFIG_IDF_TARGET_ESP32S3 || CONFIG_IDF_TARGET_LINUX || !defined(ESP_PLATFORM)
+#define DRAW_SIMD_BLOCKS    1
+#define PIE_ALIGN           16  /* EE.VLD/VST.128 игнорируют младшие 4 бита адреса */
+#define PIE_BLOCK_PX        (PIE_ALIGN / 2)
+/* Доли m для одного вызова смешивания с маской: буфер на стеке */
+#define MIX_CHUNK_PX        64
+#endif
+
+#if CONFIG_IDF_TARGET_ESP32S3
+/* draw_simd_s3.S: blocks блоков по 8 пикселей, адреса выровнены по 16.
+ * mix16: fg и m продвигаются на fg_inc/mix_inc байт за блок (0 — одно значение на все) */
+void draw_simd_fill16_pie(uint16_t *dst, uint32_t color, uint32_t blocks);
+void draw_simd_copy16_pie(uint16_t *dst, const uint16_t *src, uint32_t blocks);
+void draw_simd_mix16_pie(uint16_t *dst, const uint16_t *fg, const uint16_t *mix, uint32_t blocks,
+                         int32_t fg_inc, int32_t mix_inc);
+#elif DRAW_SIMD_BLOCKS
+/* Модель PIE-циклов: по дорожкам, в том же порядке операций и с той же
+ * разрядностью, что и draw_simd_s3.S, чтобы хостовый тест проверял арифметику */
+#define PIE_SAR             5
+
+static uint16_t vmul_u16(uint16_t x, uint16_t y)
+{
+    return (uint16_t)(((uint32_t)x * y) >> PIE_SAR);
+}
+
+static int16_t vmul_s16(int16_t x, int16_t y)
+{
+    return (int16_t)(((int32_t)x * y) >> PIE_SAR);
+}
+
+static int16_t vsat_s16(int32_t v)
+{
+    return (int16_t)(v > INT16_MAX ? INT16_MAX : v < INT16_MIN ? INT16_MIN : v);
+}
+
+static void draw_simd_fill16_pie(uint16_t *dst, uint32_t color, uint32_t blocks)
+{
+    for (uint32_t i = 0; i < blocks * PIE_BLOCK_PX; i++) {
+        dst[i] = (uint16_t)color;
+    }
+}
+
+static void draw_simd_copy16_pie(uint16_t *dst, const uint16_t *src, uint32_t blocks)
+{
+    memcpy(dst, src, blocks * PIE_ALIGN);
+}
+
+static void draw_simd_mix16_pie(uint16_t *dst, const uint16_t *fg, const uint16_t *mix, uint32_t blocks,
+                                int32_t fg_inc, int32_t mix_inc)
+{
+    for (uint32_t blk = 0; blk < blocks; blk++) {
+        for (int l = 0; l < PIE_BLOCK_PX; l++) {
+            int16_t m = (int16_t)mix[l];
+            uint16_t sf = vmul_u16(fg[l], 1);                       /* r << 6 | g */
+            uint16_t sb = vmul_u16(dst[l], 1);
+            int16_t gf = (int16_t)(sf & 0x3F);
+            int16_t gb = (int16_t)(sb & 0x3F);
+            int16_t rf = vsat_s16((int16_t)sf - gf);                /* r << 6 */
+            int16_t rb = vsat_s16((int16_t)sb - gb);
+            int16_t g = vsat_s16(gb + vmul_s16(vsat_s16(gf - gb), m));
+            int16_t r = vsat_s16(rb + vmul_s16(vsat_s16(rf - rb), m));
+            r = vsat_s16(r - (r & 0x3F));
+            uint16_t hi = vmul_u16((uint16_t)(r | g), 1024);        /* r << 11 | g << 5 */
+            int16_t bf = vsat_s16((int16_t)fg[l] - (int16_t)vmul_u16(vmul_u16(fg[l], 1), 1024));
+            int16_t bb = vsat_s16((int16_t)dst[l] - (int16_t)vmul_u16(vmul_u16(dst[l], 1), 1024));
+            int16_t b = vsat_s16(bb + vmul_s16(vsat_s16(bf - bb), m));
+            dst[l] = (uint16_t)(hi | (uint16_t)b);
+        }
+        dst += PIE_BLOCK_PX;
+        fg = (const uint16_t *)((const uint8_t *)fg + fg_inc);
+        mix = (const uint16_t *)((const uint8_t *)mix + mix_inc);
+    }
+}
+#endif
+
+static void fill_row(uint16_t *d, int32_t w, uint16_t color)
+{
+#if DRAW_SIMD_BLOCKS
+    if (w >= DRAW_SIMD_MIN_PX) {
+        while ((uintptr_t)d & (PIE_ALIGN - 1)) {
+            *d++ = color;
+            w--;
+        }
+        uint32_t blocks = (uint32_t)w / PIE_BLOCK_PX;
+        draw_simd_fill16_pie(d, color, blocks);
+        d += blocks * PIE_BLOCK_PX;
+        w -= (int32_t)(blocks * PIE_BLOCK_PX);
+    }
+#endif
+    while (w-- > 0) {
+        *d++ = color;
+    }
+}
+
+static void copy_row(uint16_t *d, const uint16_t *s, int32_t w)
+{
+#if DRAW_SIMD_BLOCKS
+    /* Сдвиг источника относительно приёмника одинаков — выравниваем оба сразу */
+    if (w >= DRAW_SIMD_MIN_PX && (((uintptr_t)d ^ (uintptr_t)s) & (PIE_ALIGN - 1)) == 0) {
+        while ((uintptr_t)d & (PIE_ALIGN - 1)) {
+            *d++ = *s++;
+            w--;
+        }
+        uint32_t blocks = (uint32_t)w / PIE_BLOCK_PX;
+        draw_simd_copy16_pie(d, s, blocks);
+        d += blocks * PIE_BLOCK_PX;
+        s += blocks * PIE_BLOCK_PX;
+        w -= (int32_t)(blocks * PIE_BLOCK_PX);
+    }
+#endif
+    memcpy(d, s, (size_t)w * sizeof(uint16_t));
+}
+
+/* Доля 0..255 -> множитель 0..32, как в lv_color_16_16_mix() */
+static inline uint16_t mix_to_m(uint32_t mix)
+{
+    return (uint16_t)((mix + 4) >> 3);
+}
+
+static inline uint32_t mask_mix(uint8_t mask, uint8_t opa)
+{
+    return opa == DRAW_SIMD_OPA_COVER ? mask : ((uint32_t)mask * opa) >> 8;
+}
+
+/* Эталон: покомпонентно fg * m + bg * (32 - m) >> 5 == lv_color_16_16_mix() */
+static inline uint16_t mix16(uint16_t fg, uint16_t bg, uint32_t m)
+{
+    uint32_t im = 32 - m;
+    uint32_t r = (((uint32_t)(fg >> 11) * m + (uint32_t)(bg >> 11) * im) >> 5) << 11;
+    uint32_t g = ((((fg >> 5) & 0x3Fu) * m + ((bg >> 5) & 0x3Fu) * im) >> 5) << 5;
+    uint32_t b = ((fg & 0x1Fu) * m + (bg & 0x1Fu) * im) >> 5;
+    return (uint16_t)(r | g | b);
+}
+
+/* fg — s[x] или сплошной color (s == NULL); доля — opa или маска */
+static void mix_row_c(uint16_t *d, const uint16_t *s, uint16_t color, const uint8_t *mask, uint8_t opa, int32_t w)
+{
+    uint32_t m = mix_to_m(opa);
+    for (int32_t x = 0; x < w; x++) {
+        if (mask) {
+            m = mix_to_m(mask_mix(mask[x], opa));
+        }
+        d[x] = mix16(s ? s[x] : color, d[x], m);
+    }
+}
+
+static void mix_row(uint16_t *d, const uint16_t *s, uint16_t color, const uint8_t *mask, uint8_t opa, int32_t w)
+{
+#if DRAW_SIMD_BLOCKS
+    if (w >= DRAW_SIMD_MIN_PX && (!s || (((uintptr_t)d ^ (uintptr_t)s) & (PIE_ALIGN - 1)) == 0)) {
+        int32_t head = (int32_t)(((PIE_ALIGN - ((uintptr_t)d & (PIE_ALIGN - 1))) & (PIE_ALIGN - 1)) / sizeof(uint16_t));
+        mix_row_c(d, s, color, mask, opa, head);
+        d += head;
+        s = s ? s + head : NULL;
+        mask = mask ? mask + head : NULL;
+        w -= head;
+
+        uint16_t fg[PIE_BLOCK_PX] __attribute__((aligned(PIE_ALIGN)));
+        uint16_t m[MIX_CHUNK_PX] __attribute__((aligned(PIE_ALIGN)));
+        for (int i = 0; i < PIE_BLOCK_PX; i++) {
+            fg[i] = color;
+            m[i] = mix_to_m(opa);
+        }
+        while (w >= PIE_BLOCK_PX) {
+            int32_t n = (w < MIX_CHUNK_PX ? w : MIX_CHUNK_PX) & ~(PIE_BLOCK_PX - 1);
+            if (mask) {
+                for (int32_t i = 0; i < n; i++) {
+                    m[i] = mix_to_m(mask_mix(mask[i], opa));
+                }
+                mask += n;
+            }
+            draw_simd_mix16_pie(d, s ? s : fg, m, (uint32_t)n / PIE_BLOCK_PX, s ? PIE_ALIGN : 0, mask ? PIE_ALIGN : 0);
+            d += n;
+            s = s ? s + n : NULL;
+            w -= n;
+        }
+    }
+#endif
+    mix_row_c(d, s, color, mask, opa, w);
+}
+
+void draw_simd_fill16(void *dst, int32_t w, int32_t h, int32_t dst_stride, uint16_t color)
+{
+    uint8_t *row = (uint8_t *)dst;
+    for (int32_t y = 0; y < h; y++) {
+        fill_row((uint16_t *)row, w, color);
+        row += dst_stride;
+    }
+}
+
+void draw_simd_copy16(void *dst, int32_t dst_stride, const void *src, int32_t src_stride, int32_t w, int32_t h)
+{
+    uint8_t *d = (uint8_t *)dst;
+    const uint8_t *s = (const uint8_t *)src;
+    for (int32_t y = 0; y < h; y++) {
+        copy_row((uint16_t *)d, (const uint16_t *)s, w);
+        d += dst_stride;
+        s += src_stride;
+    }
+}
+
+void draw_simd_fill16_mix(void *dst, int32_t w, int32_t h, int32_t dst_stride, uint16_t color,
+                          const uint8_t *mask, int32_t mask_stride, uint8_t opa)
+{
+    uint8_t *d = (uint8_t *)dst;
+    for (int32_t y = 0; y < h; y++) {
+        mix_row((uint16_t *)d, NULL, color, mask, opa, w);
+        d += dst_stride;
+        if (mask) {
+            mask += mask_stride;
+        }
+    }
+}
+
+void draw_simd_blend16(void *dst, int32_t dst_stride, const void *src, int32_t src_stride, int32_t w, int32_t h,
+                       const uint8_t *mask, int32_t mask_stride, uint8_t opa)
+{
+    uint8_t *d = (uint8_t *)dst;
+    const uint8_t *s = (const uint8_t *)src;
+    for (int32_t y = 0; y < h; y++) {
+        mix_row((uint16_t *)d, (const uint16_t *)s, 0, mask, opa, w);
+        d += dst_stride;
+        s += src_stride;
+        if (mask) {
+            mask += mask_stride;
+        }
+    }
+}
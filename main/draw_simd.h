@@ -0,0 +1,79 @@
+/**
+ * @file draw_simd.h
+ * @brief Заливка, копирование и смешивание RGB565 на векторном блоке PIE ESP32-S3
+ *
+ * Подключается в lv_draw_sw_blend_to_rgb565.c через
+ * CONFIG_LV_DRAW_SW_ASM_CUSTOM_INCLUDE и подменяет циклы программного
+ * рендера RGB565 -> RGB565: заливку цветом (сплошную, с opa, с маской
+ * сглаживания) и вывод RGB565-изображения (непрозрачный, с opa, с маской).
+ *
+ * Смешивание совпадает с lv_color_16_16_mix() бит в бит: LVGL считает на
+ * упакованном 32-битном слове, но каналы там не залезают друг в друга, и
+ * результат равен покомпонентному bg + ((fg - bg) * m >> 5), m = (mix + 4) >> 3.
+ * Канал на m умещается в 16 бит, это и считает EE.VMUL.S16 по 8 дорожкам.
+ *
+ * Строки короче DRAW_SIMD_MIN_PX и несовпадающее выравнивание обрабатываются
+ * обычным C-кодом. На хосте вместо PIE-циклов работает их модель на C с той же
+ * арифметикой по дорожкам (test/host/test_draw_simd.c), на других ESP — C.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/* Короче этого выгоднее простой цикл */
+#define DRAW_SIMD_MIN_PX    32
+
+/* opa без маски-множителя: доля берётся из маски как есть (LV_OPA_COVER) */
+#define DRAW_SIMD_OPA_COVER 255
+
+/* strides в байтах, как в lv_draw_sw_blend_*_dsc_t */
+void draw_simd_fill16(void *dst, int32_t w, int32_t h, int32_t dst_stride, uint16_t color);
+void draw_simd_copy16(void *dst, int32_t dst_stride, const void *src, int32_t src_stride, int32_t w, int32_t h);
+
+/**
+ * @brief Заливка цветом поверх приёмника. Доля цвета: opa, если mask == NULL;
+ * mask[x], если opa == DRAW_SIMD_OPA_COVER; иначе mask[x] * opa >> 8 (LV_OPA_MIX2).
+ */
+void draw_simd_fill16_mix(void *dst, int32_t w, int32_t h, int32_t dst_stride, uint16_t color,
+                          const uint8_t *mask, int32_t mask_stride, uint8_t opa);
+
+/** @brief Вывод RGB565-изображения поверх приёмника, доля — как в draw_simd_fill16_mix() */
+void draw_simd_blend16(void *dst, int32_t dst_stride, const void *src, int32_t src_stride, int32_t w, int32_t h,
+                       const uint8_t *mask, int32_t mask_stride, uint8_t opa);
+
+#define LV_DRAW_SW_COLOR_BLEND_TO_RGB565(dsc) \
+    (draw_simd_fill16((dsc)->dest_buf, (dsc)->dest_w, (dsc)->dest_h, (dsc)->dest_stride, \
+                      lv_color_to_u16((dsc)->color)), LV_RESULT_OK)
+
+#define LV_DRAW_SW_COLOR_BLEND_TO_RGB565_WITH_OPA(dsc) \
+    (draw_simd_fill16_mix((dsc)->dest_buf, (dsc)->dest_w, (dsc)->dest_h, (dsc)->dest_stride, \
+                          lv_color_to_u16((dsc)->color), NULL, 0, (dsc)->opa), LV_RESULT_OK)
+
+#define LV_DRAW_SW_COLOR_BLEND_TO_RGB565_WITH_MASK(dsc) \
+    (draw_simd_fill16_mix((dsc)->dest_buf, (dsc)->dest_w, (dsc)->dest_h, (dsc)->dest_stride, \
+                          lv_color_to_u16((dsc)->color), (dsc)->mask_buf, (dsc)->mask_stride, \
+                          DRAW_SIMD_OPA_COVER), LV_RESULT_OK)
+
+#define LV_DRAW_SW_COLOR_BLEND_TO_RGB565_MIX_MASK_OPA(dsc) \
+    (draw_simd_fill16_mix((dsc)->dest_buf, (dsc)->dest_w, (dsc)->dest_h, (dsc)->dest_stride, \
+                          lv_color_to_u16((dsc)->color), (dsc)->mask_buf, (dsc)->mask_stride, \
+                          (dsc)->opa), LV_RESULT_OK)
+
+#define LV_DRAW_SW_RGB565_BLEND_NORMAL_TO_RGB565(dsc) \
+    (draw_simd_copy16((dsc)->dest_buf, (dsc)->dest_stride, (dsc)->src_buf, (dsc)->src_stride, \
+                      (dsc)->dest_w, (dsc)->dest_h), LV_RESULT_OK)
+
+#define LV_DRAW_SW_RGB565_BLEND_NORMAL_TO_RGB565_WITH_OPA(dsc) \
+    (draw_simd_blend16((dsc)->dest_buf, (dsc)->dest_stride, (dsc)->src_buf, (dsc)->src_stride, \
+                       (dsc)->dest_w, (dsc)->dest_h, NULL, 0, (dsc)->opa), LV_RESULT_OK)
+
+#define LV_DRAW_SW_RGB565_BLEND_NORMAL_TO_RGB565_WITH_MASK(dsc) \
+    (draw_simd_blend16((dsc)->dest_buf, (dsc)->dest_stride, (dsc)->src_buf, (dsc)->src_stride, \
+                       (dsc)->dest_w, (dsc)->dest_h, (dsc)->mask_buf, (dsc)->mask_stride, \
+                       DRAW_SIMD_OPA_COVER), LV_RESULT_OK)
+
+#define LV_DRAW_SW_RGB565_BLEND_NORMAL_TO_RGB565_MIX_MASK_OPA(dsc) \
+    (draw_simd_blend16((dsc)->dest_buf, (dsc)->dest_stride, (dsc)->src_buf, (dsc)->src_stride, \
+                       (dsc)->dest_w, (dsc)->dest_h, (dsc)->mask_buf, (dsc)->mask_stride, \
+                       (dsc)->opa), LV_RESULT_OK)
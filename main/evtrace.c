@@ -0,0 +1,244 @@
+/**
+ * @file evtrace.c
+ * @brief Кольца событий по ядрам и выгрузка в формате Chrome trace
+ */
+
+#include "evtrace.h"
+
+#if CONFIG_EVTRACE
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "esp_attr.h"
+#include "esp_console.h"
+#include "esp_cpu.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static const char *TAG = "EVTRACE";
+
+#define EVTRACE_CORES   2
+#define EVTRACE_EVENTS  CONFIG_EVTRACE_EVENTS
+#define EVTRACE_TASKS_MAX 24
+_Static_assert((EVTRACE_EVENTS & (EVTRACE_EVENTS - 1)) == 0, "EVTRACE_EVENTS must be a power of two");
+_Static_assert(sizeof(evtrace_rec_t) == 16, "dump format expects 16-byte records");
+
+static const char *const evtrace_names[EVTRACE_COUNT] = {
+    [EVTRACE_LV_TIMER] = "lv_timer_handler",
+    [EVTRACE_ASYNC_CALL] = "async_call",
+    [EVTRACE_RENDER] = "render",
+    [EVTRACE_FLUSH] = "flush_cb",
+    [EVTRACE_FLUSH_WAIT] = "flush_wait",
+    [EVTRACE_FLUSH_TILES] = "flush_tiles",
+    [EVTRACE_FLUSH_DONE] = "flush_done",
+    [EVTRACE_TOUCH_READ] = "gt911_read",
+    [EVTRACE_UPDATE_LABELS] = "update_labels",
+    [EVTRACE_UI_TIMER] = "ui_timer",
+};
+
+typedef struct {
+    evtrace_rec_t *buf;
+    atomic_uint head;           /* всего зарезервировано слотов */
+} evtrace_ring_t;
+
+/* Имена задач запоминаются при первой записи: к выгрузке задача может
+ * быть уже удалена */
+typedef struct {
+    uint32_t task;
+    char name[configMAX_TASK_NAME_LEN];
+} evtrace_task_t;
+
+/* Пишут все задачи и ISR ядра; кольца в PSRAM — кэш при записи во flash
+ * не отключается (CONFIG_SPIRAM_XIP_FROM_PSRAM) */
+static evtrace_ring_t s_rings[EVTRACE_CORES];
+static volatile bool s_enabled = false;
+static evtrace_task_t s_tasks[EVTRACE_TASKS_MAX];
+static atomic_int s_task_cnt;
+static portMUX_TYPE s_task_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/* Только из задачи: имя текущей */
+static void note_task(uint32_t task)
+{
+    int n = atomic_load_explicit(&s_task_cnt, memory_order_acquire);
+    for (int i = 0; i < n; i++) {
+        if (s_tasks[i].task == task) return;
+    }
+    portENTER_CRITICAL(&s_task_lock);
+    n = atomic_load_explicit(&s_task_cnt, memory_order_relaxed);
+    bool known = false;
+    for (int i = 0; i < n; i++) {
+        known = known || s_tasks[i].task == task;
+    }
+    if (!known && n < EVTRACE_TASKS_MAX) {
+        s_tasks[n].task = task;
+        strlcpy(s_tasks[n].name, pcTaskGetName(NULL), sizeof(s_tasks[n].name));
+        atomic_store_explicit(&s_task_cnt, n + 1, memory_order_release);
+    }
+    portEXIT_CRITICAL(&s_task_lock);
+}
+
+static void IRAM_ATTR put(evtrace_id_t id, uint32_t ts, uint32_t dur)
+{
+    uint32_t core = (uint32_t)esp_cpu_get_core_id();
+    evtrace_ring_t *r = &s_rings[core];
+    uint32_t slot = atomic_fetch_add_explicit(&r->head, 1, memory_order_relaxed) & (EVTRACE_EVENTS - 1);
+    evtrace_rec_t *e = &r->buf[slot];
+    e->ts_us = ts;
+    e->dur_us = dur;
+    uint32_t task = 0;
+    if (!xPortInIsrContext()) {
+        task = (uint32_t)(uintptr_t)xTaskGetCurrentTaskHandle();
+        note_task(task);
+    }
+    e->task = task;
+    e->id = (uint16_t)id;
+    e->core = (uint8_t)core;
+    e->reserved = 0;
+}
+
+uint32_t IRAM_ATTR evtrace_now(void)
+{
+    return (uint32_t)esp_timer_get_time();
+}
+
+void IRAM_ATTR evtrace_span(evtrace_id_t id, uint32_t start)
+{
+    if (!s_enabled) return;
+    uint32_t dur = evtrace_now() - start;
+    put(id, start, dur < EVTRACE_INSTANT ? dur : EVTRACE_INSTANT - 1);
+}
+
+void IRAM_ATTR evtrace_instant(evtrace_id_t id)
+{
+    if (!s_enabled) return;
+    put(id, evtrace_now(), EVTRACE_INSTANT);
+}
+
+void evtrace_init(void)
+{
+    for (int core = 0; core < EVTRACE_CORES; core++) {
+        s_rings[core].buf = heap_caps_calloc(EVTRACE_EVENTS, sizeof(evtrace_rec_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (s_rings[core].buf == NULL) {
+            ESP_LOGE(TAG, "No PSRAM for %u trace events", (unsigned)EVTRACE_EVENTS);
+            return;
+        }
+    }
+    s_enabled = true;
+}
+
+/* Записи кольца от старых к новым */
+static void ring_walk(const evtrace_ring_t *r, void (*fn)(const evtrace_rec_t *e, bool *first), bool *first)
+{
+    uint32_t head = atomic_load((atomic_uint *)&r->head);
+    uint32_t i = head > EVTRACE_EVENTS ? head - EVTRACE_EVENTS : 0;
+    for (; i < head; i++) {
+        fn(&r->buf[i & (EVTRACE_EVENTS - 1)], first);
+    }
+}
+
+static void print_json_event(const evtrace_rec_t *e, bool *first)
+{
+    if (e->id >= EVTRACE_COUNT) return;
+    printf("%s{\"name\":\"%s\",\"pid\":1,\"tid\":%u,\"ts\":%u,", *first ? "" : ",\n",
+           evtrace_names[e->id], (unsigned)e->task, (unsigned)e->ts_us);
+    if (e->dur_us == EVTRACE_INSTANT) {
+        printf("\"ph\":\"i\",\"s\":\"t\",\"args\":{\"core\":%u}}", e->core);
+    } else {
+        printf("\"ph\":\"X\",\"dur\":%u,\"args\":{\"core\":%u}}", (unsigned)e->dur_us, e->core);
+    }
+    *first = false;
+}
+
+static void print_hex_event(const evtrace_rec_t *e, bool *first)
+{
+    const uint8_t *p = (const uint8_t *)e;
+    (void)first;
+    printf("ev ");
+    for (size_t i = 0; i < sizeof(*e); i++) {
+        printf("%02x", p[i]);
+    }
+    printf("\n");
+}
+
+static void dump_json(void)
+{
+    bool first = true;
+    printf("{\"traceEvents\":[\n");
+    for (int core = 0; core < EVTRACE_CORES; core++) {
+        ring_walk(&s_rings[core], print_json_event, &first);
+    }
+    printf("%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"ISR\"}}",
+           first ? "" : ",\n");
+    int n = atomic_load(&s_task_cnt);
+    for (int t = 0; t < n; t++) {
+        printf(",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+               (unsigned)s_tasks[t].task, s_tasks[t].name);
+    }
+    printf("\n]}\n");
+}
+
+/* Строки «task <handle> <имя>», затем «ev <запись hex>» */
+static void dump_hex(void)
+{
+    bool first = true;
+    int n = atomic_load(&s_task_cnt);
+    for (int t = 0; t < n; t++) {
+        printf("task %u %s\n", (unsigned)s_tasks[t].task, s_tasks[t].name);
+    }
+    for (int core = 0; core < EVTRACE_CORES; core++) {
+        ring_walk(&s_rings[core], print_hex_event, &first);
+    }
+}
+
+static int evtrace_cmd(int argc, char **argv)
+{
+    const char *op = argc > 1 ? argv[1] : "";
+    if (s_rings[0].buf == NULL) {
+        printf("not initialized\n");
+        return 1;
+    }
+    if (strcmp(op, "start") == 0) {
+        s_enabled = true;
+    } else if (strcmp(op, "stop") == 0) {
+        s_enabled = false;
+    } else if (strcmp(op, "clear") == 0) {
+        bool was = s_enabled;
+        s_enabled = false;
+        for (int core = 0; core < EVTRACE_CORES; core++) {
+            atomic_store(&s_rings[core].head, 0);
+        }
+        s_enabled = was;
+    } else if (strcmp(op, "dump") == 0) {
+        /* Пока печатаем, кольца не двигаются */
+        bool was = s_enabled;
+        s_enabled = false;
+        if (argc > 2 && strcmp(argv[2], "hex") == 0) {
+            dump_hex();
+        } else {
+            dump_json();
+        }
+        s_enabled = was;
+    } else {
+        printf("usage: evtrace start|stop|clear|dump [hex]\n");
+        return 1;
+    }
+    return 0;
+}
+
+void evtrace_register_cmd(void)
+{
+    const esp_console_cmd_t cmd = {
+        .command = "evtrace",
+        .help = "Event trace of UI, touch and flush; 'evtrace dump' prints Chrome trace JSON",
+        .hint = "start|stop|clear|dump [hex]",
+        .func = &evtrace_cmd,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&cmd));
+}
+
+#endif /* CONFIG_EVTRACE */
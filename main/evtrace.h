@@ -0,0 +1,70 @@
+/**
+ * @file evtrace.h
+ * @brief Трасса событий UI, тача и вывода для chrome://tracing / Perfetto
+ *
+ * Каждое событие — отрезок (начало и длительность) или мгновенная отметка
+ * с ядром и задачей. Записи идут в кольцо своего ядра в PSRAM без
+ * блокировок: слот резервируется атомарным инкрементом, старые записи
+ * затираются. Отрезок пишется одной записью по окончании, поэтому
+ * неинтересный (опрос GT911 без новых данных) можно просто не записать.
+ *
+ * «evtrace dump» печатает трассу JSON-ом Chrome trace, «evtrace dump hex» —
+ * сырые записи, которые tools/evtrace_to_json.py переводит в тот же JSON.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "sdkconfig.h"
+
+typedef enum {
+    EVTRACE_LV_TIMER = 0,       /* lv_timer_handler() */
+    EVTRACE_ASYNC_CALL,         /* display_async_call(): чтение индева и т.п. */
+    EVTRACE_RENDER,             /* RENDER_START..RENDER_READY */
+    EVTRACE_FLUSH,              /* lvgl_flush_cb() */
+    EVTRACE_FLUSH_WAIT,         /* LVGL ждёт flush_ready */
+    EVTRACE_FLUSH_TILES,        /* отбор изменённых тайлов */
+    EVTRACE_FLUSH_DONE,         /* мгновенное: асинхронная копия закончена (ISR) */
+    EVTRACE_TOUCH_READ,         /* I2C-чтение кадра GT911 с новыми данными */
+    EVTRACE_UPDATE_LABELS,
+    EVTRACE_UI_TIMER,           /* таймеры UI (room_temp_timer_cb) */
+    EVTRACE_COUNT,
+} evtrace_id_t;
+
+/* Запись в кольце, она же формат «dump hex» (little-endian) */
+typedef struct {
+    uint32_t ts_us;             /* младшие 32 бита esp_timer_get_time() */
+    uint32_t dur_us;            /* UINT32_MAX — мгновенное событие */
+    uint32_t task;              /* TaskHandle_t, 0 — ISR */
+    uint16_t id;
+    uint8_t core;
+    uint8_t reserved;
+} evtrace_rec_t;
+
+#define EVTRACE_INSTANT UINT32_MAX
+
+#if CONFIG_EVTRACE
+
+/* Выделить кольца и начать запись */
+void evtrace_init(void);
+
+uint32_t evtrace_now(void);
+
+/* Отрезок от start (evtrace_now()) до текущего момента */
+void evtrace_span(evtrace_id_t id, uint32_t start);
+
+/* Мгновенное событие; можно из ISR */
+void evtrace_instant(evtrace_id_t id);
+
+/* Команда консоли «evtrace» */
+void evtrace_register_cmd(void);
+
+#else
+
+static inline void evtrace_init(void) {}
+static inline uint32_t evtrace_now(void) { return 0; }
+static inline void evtrace_span(evtrace_id_t id, uint32_t start) { (void)id; (void)start; }
+static inline void evtrace_instant(evtrace_id_t id) { (void)id; }
+static inline void evtrace_register_cmd(void) {}
+
+#endif
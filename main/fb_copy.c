@@ -0,0 +1,94 @@
+/**
+ * @file fb_copy.c
+ * @brief Раскладка области на сегменты и прогон через движок копирования
+ */
+
+#include <string.h>
+#include "fb_copy.h"
+
+static fb_copy_status_t memcpy_start(void *ctx, const fb_copy_seg_t *seg, fb_copy_job_t *job)
+{
+    (void)ctx;
+    (void)job;
+    memcpy(seg->dst, seg->src, seg->len);
+    return FB_COPY_DONE;
+}
+
+const fb_copy_engine_t fb_copy_engine_memcpy = {
+    .start = memcpy_start,
+    .prepare = NULL,
+    .ctx = NULL,
+};
+
+bool fb_copy_next_seg(fb_copy_job_t *job, fb_copy_seg_t *seg)
+{
+    while (job->rect_idx < job->rect_cnt) {
+        const fb_rect_t *r = &job->rects[job->rect_idx];
+        if (job->row > r->y2) {
+            job->rect_idx++;
+            if (job->rect_idx < job->rect_cnt) {
+                job->row = job->rects[job->rect_idx].y1;
+            }
+            continue;
+        }
+
+        size_t row_bytes = (size_t)(r->x2 - r->x1 + 1) * job->px_size;
+        size_t src_off = (size_t)(job->row - job->area.y1) * job->src_stride
+                       + (size_t)(r->x1 - job->area.x1) * job->px_size;
+        size_t dst_off = (size_t)job->row * job->fb_stride + (size_t)r->x1 * job->px_size;
+        int32_t rows = 1;
+        /* Обе стороны без «дыр» между строками — копируем прямоугольник одним куском */
+        if (row_bytes == job->src_stride && row_bytes == job->fb_stride) {
+            rows = r->y2 - job->row + 1;
+        }
+
+        seg->dst = job->fb + dst_off;
+        seg->src = job->src + src_off;
+        seg->len = row_bytes * (size_t)rows;
+        job->row += rows;
+        return true;
+    }
+    return false;
+}
+
+/* Гоним сегменты, пока движок копирует синхронно; на асинхронном выходим
+ * и продолжаем из fb_copy_job_seg_done(). В полёте не больше одного сегмента,
+ * поэтому состояние job не нуждается в блокировке. */
+static void job_pump(fb_copy_job_t *job)
+{
+    fb_copy_seg_t seg;
+    while (fb_copy_next_seg(job, &seg)) {
+        fb_copy_status_t st = job->engine->start(job->engine->ctx, &seg, job);
+        if (st == FB_COPY_PENDING) {
+            return;
+        }
+        if (st == FB_COPY_ERROR) {
+            memcpy(seg.dst, seg.src, seg.len);
+        }
+    }
+    job->done_cb(job->done_arg);
+}
+
+static void job_rewind(fb_copy_job_t *job)
+{
+    job->rect_idx = 0;
+    job->row = job->rect_cnt ? job->rects[0].y1 : 0;
+}
+
+void fb_copy_job_start(fb_copy_job_t *job)
+{
+    if (job->engine->prepare) {
+        fb_copy_seg_t seg;
+        job_rewind(job);
+        while (fb_copy_next_seg(job, &seg)) {
+            job->engine->prepare(job->engine->ctx, &seg);
+        }
+    }
+    job_rewind(job);
+    job_pump(job);
+}
+
+void fb_copy_job_seg_done(fb_copy_job_t *job)
+{
+    job_pump(job);
+}
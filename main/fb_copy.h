@@ -0,0 +1,104 @@
+/**
+ * @file fb_copy.h
+ * @brief Копирование отрисованной области LVGL во фрейм-буфер панели
+ *
+ * Область (и её подпрямоугольники) раскладывается на непрерывные сегменты
+ * с учётом stride источника и фрейм-буфера, сегменты по одному отдаются
+ * «движку копирования». Движок может копировать сразу (memcpy) или
+ * асинхронно (GDMA) и сообщать о завершении из ISR.
+ *
+ * Модуль не зависит от ESP-IDF и LVGL и собирается на хосте.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Прямоугольник в координатах экрана, границы включительно (как lv_area_t) */
+typedef struct {
+    int32_t x1;
+    int32_t y1;
+    int32_t x2;
+    int32_t y2;
+} fb_rect_t;
+
+/* Непрерывный кусок памяти для копирования */
+typedef struct {
+    uint8_t *dst;
+    const uint8_t *src;
+    size_t len;
+} fb_copy_seg_t;
+
+typedef struct fb_copy_job fb_copy_job_t;
+
+typedef enum {
+    FB_COPY_DONE,       /* сегмент скопирован до возврата */
+    FB_COPY_PENDING,    /* движок вызовет fb_copy_job_seg_done() по завершении */
+    FB_COPY_ERROR,      /* не удалось поставить в очередь, job скопирует сам */
+} fb_copy_status_t;
+
+typedef struct {
+    fb_copy_status_t (*start)(void *ctx, const fb_copy_seg_t *seg, fb_copy_job_t *job);
+    /* Необязательно: вызывается для каждого сегмента в контексте
+     * fb_copy_job_start() до первого start() (синхронизация кэша и т.п.,
+     * чего нельзя делать из ISR завершения) */
+    void (*prepare)(void *ctx, const fb_copy_seg_t *seg);
+    void *ctx;
+} fb_copy_engine_t;
+
+struct fb_copy_job {
+    /* Источник: буфер LVGL, левый верхний пиксель соответствует area.x1/y1 */
+    const uint8_t *src;
+    size_t src_stride;
+    fb_rect_t area;
+
+    /* Приёмник: фрейм-буфер панели целиком */
+    uint8_t *fb;
+    size_t fb_stride;
+    uint8_t px_size;
+
+    /* Какие части area копировать (лежат внутри area) */
+    const fb_rect_t *rects;
+    size_t rect_cnt;
+
+    const fb_copy_engine_t *engine;
+    void (*done_cb)(void *arg);
+    void *done_arg;
+
+    /* Внутреннее состояние итератора */
+    size_t rect_idx;
+    int32_t row;
+};
+
+/* Синхронный движок на memcpy: запасной вариант на устройстве и эталон на хосте */
+extern const fb_copy_engine_t fb_copy_engine_memcpy;
+
+/**
+ * @brief Запустить копирование. done_cb вызывается ровно один раз — сразу,
+ * если движок синхронный, или из контекста завершения последнего сегмента.
+ */
+void fb_copy_job_start(fb_copy_job_t *job);
+
+/**
+ * @brief Сегмент, отданный движком со статусом FB_COPY_PENDING, завершён.
+ * Можно вызывать из ISR.
+ */
+void fb_copy_job_seg_done(fb_copy_job_t *job);
+
+/**
+ * @brief Следующий сегмент задания. Строки прямоугольника склеиваются в один
+ * сегмент, когда он занимает всю ширину и у источника, и у фрейм-буфера.
+ * @return false, когда сегменты закончились
+ */
+bool fb_copy_next_seg(fb_copy_job_t *job, fb_copy_seg_t *seg);
+
+#ifdef ESP_PLATFORM
+/**
+ * @brief Движок на GDMA async memcpy (ESP32-S3). Адреса и длины сегментов во
+ * фрейм-буфере должны быть выровнены по align байт.
+ * @return true, если канал GDMA получен
+ */
+bool fb_copy_gdma_init(fb_copy_engine_t *engine, size_t align);
+#endif
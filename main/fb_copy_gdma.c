@@ -0,0 +1,66 @@
+/**
+ * @file fb_copy_gdma.c
+ * @brief Движок копирования на GDMA async memcpy (ESP32-S3)
+ *
+ * SRAM-буфер LVGL -> фрейм-буфер в PSRAM без участия CPU. Завершение
+ * сегмента приходит из ISR GDMA, оттуда же ставится следующий сегмент.
+ * Кэш синхронизируется только в prepare(), в задаче LVGL до запуска
+ * задания: из ISR esp_cache_msync() не зовём.
+ */
+
+#include "esp_async_memcpy.h"
+#include "esp_attr.h"
+#include "esp_cache.h"
+#include "esp_log.h"
+#include "esp_memory_utils.h"
+#include "fb_copy.h"
+
+static const char *TAG = "FB_COPY";
+
+/* Больше одного сегмента в полёте job не держит */
+#define GDMA_BACKLOG    2
+
+static async_memcpy_handle_t s_mcp = NULL;
+
+static bool IRAM_ATTR gdma_copy_done(async_memcpy_handle_t mcp, async_memcpy_event_t *event, void *cb_args)
+{
+    (void)mcp;
+    (void)event;
+    fb_copy_job_seg_done((fb_copy_job_t *)cb_args);
+    return false;
+}
+
+/* В кэше не должно остаться строк приёмника: иначе при вытеснении они
+ * перекроют данные от DMA. Чтобы ISR bounce-буфера не подтянул старые
+ * строки во время DMA, панель создаётся с bb_invalidate_cache. */
+static void gdma_prepare(void *ctx, const fb_copy_seg_t *seg)
+{
+    (void)ctx;
+    if (esp_ptr_external_ram(seg->dst)) {
+        esp_cache_msync(seg->dst, seg->len, ESP_CACHE_MSYNC_FLAG_DIR_C2M | ESP_CACHE_MSYNC_FLAG_INVALIDATE);
+    }
+}
+
+static fb_copy_status_t gdma_start(void *ctx, const fb_copy_seg_t *seg, fb_copy_job_t *job)
+{
+    (void)ctx;
+    esp_err_t err = esp_async_memcpy(s_mcp, seg->dst, (void *)seg->src, seg->len, gdma_copy_done, job);
+    return err == ESP_OK ? FB_COPY_PENDING : FB_COPY_ERROR;
+}
+
+bool fb_copy_gdma_init(fb_copy_engine_t *engine, size_t align)
+{
+    async_memcpy_config_t cfg = ASYNC_MEMCPY_DEFAULT_CONFIG();
+    cfg.backlog = GDMA_BACKLOG;
+    cfg.dma_burst_size = align;
+    esp_err_t err = esp_async_memcpy_install(&cfg, &s_mcp);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "async memcpy install failed: %s, using CPU copy", esp_err_to_name(err));
+        *engine = fb_copy_engine_memcpy;
+        return false;
+    }
+    engine->start = gdma_start;
+    engine->prepare = gdma_prepare;
+    engine->ctx = NULL;
+    return true;
+}
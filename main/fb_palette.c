@@ -0,0 +1,103 @@
+/**
+ * @file fb_palette.c
+ * @brief Построение палитры из цветов UI и квантование RGB565
+ */
+
+#include "fb_palette.h"
+
+static uint16_t rgb888_to_565(uint32_t rgb)
+{
+    return (uint16_t)(((rgb >> 8) & 0xF800) | ((rgb >> 5) & 0x07E0) | ((rgb >> 3) & 0x001F));
+}
+
+/* Обратно в 8 бит на канал с размножением старших битов */
+static void rgb565_to_888(uint16_t c, int32_t *r, int32_t *g, int32_t *b)
+{
+    int32_t r5 = (c >> 11) & 0x1F;
+    int32_t g6 = (c >> 5) & 0x3F;
+    int32_t b5 = c & 0x1F;
+    *r = (r5 << 3) | (r5 >> 2);
+    *g = (g6 << 2) | (g6 >> 4);
+    *b = (b5 << 3) | (b5 >> 2);
+}
+
+static uint32_t mix(uint32_t a, uint32_t b, uint32_t num, uint32_t den)
+{
+    uint32_t out = 0;
+    for (int shift = 0; shift <= 16; shift += 8) {
+        uint32_t ca = (a >> shift) & 0xFF;
+        uint32_t cb = (b >> shift) & 0xFF;
+        out |= ((ca * (den - num) + cb * num) / den) << shift;
+    }
+    return out;
+}
+
+/* Взвешенное расстояние: глаз чувствительнее всего к зелёному */
+static uint32_t dist(int32_t r1, int32_t g1, int32_t b1, int32_t r2, int32_t g2, int32_t b2)
+{
+    int32_t dr = r1 - r2;
+    int32_t dg = g1 - g2;
+    int32_t db = b1 - b2;
+    return (uint32_t)(2 * dr * dr + 4 * dg * dg + 3 * db * db);
+}
+
+void fb_palette_build(fb_palette_t *p, const uint32_t *ui_colors, size_t n)
+{
+    size_t cnt = 0;
+
+    if (n > FB_PALETTE_UI_MAX) {
+        n = FB_PALETTE_UI_MAX;
+    }
+    for (size_t i = 0; i < n; i++) {
+        p->rgb565[cnt++] = rgb888_to_565(ui_colors[i]);
+    }
+    /* Сглаженные края: цвет на фоне в промежуточных долях */
+    for (size_t i = 1; i < n; i++) {
+        for (uint32_t s = 1; s <= FB_PALETTE_BLEND_STEPS; s++) {
+            p->rgb565[cnt++] = rgb888_to_565(mix(ui_colors[0], ui_colors[i], s, FB_PALETTE_BLEND_STEPS + 1));
+        }
+    }
+    for (uint32_t r = 0; r < 5; r++) {
+        for (uint32_t g = 0; g < 6; g++) {
+            for (uint32_t b = 0; b < 5; b++) {
+                p->rgb565[cnt++] = rgb888_to_565(((r * 255 / 4) << 16) | ((g * 255 / 5) << 8) | (b * 255 / 4));
+            }
+        }
+    }
+    /* Остаток — серая шкала */
+    size_t rest = FB_PALETTE_SIZE - cnt;
+    for (size_t i = 0; cnt < FB_PALETTE_SIZE; i++) {
+        uint32_t v = (uint32_t)((i + 1) * 255 / (rest + 1));
+        p->rgb565[cnt++] = rgb888_to_565((v << 16) | (v << 8) | v);
+    }
+
+    /* Ближайший цвет палитры для центра каждой ячейки 4:4:4 */
+    for (uint32_t key = 0; key < FB_PALETTE_LUT_SIZE; key++) {
+        uint16_t c = (uint16_t)(((key & 0xF00) << 4) | 0x0800 | ((key & 0x0F0) << 3) | 0x0040
+                              | ((key & 0x00F) << 1) | 0x0001);
+        int32_t r, g, b;
+        rgb565_to_888(c, &r, &g, &b);
+        uint32_t best = UINT32_MAX;
+        for (size_t i = 0; i < FB_PALETTE_SIZE; i++) {
+            int32_t pr, pg, pb;
+            rgb565_to_888(p->rgb565[i], &pr, &pg, &pb);
+            uint32_t d = dist(r, g, b, pr, pg, pb);
+            if (d < best) {
+                best = d;
+                p->lut[key] = (uint8_t)i;
+            }
+        }
+    }
+    /* Цвета UI попадают в свою ячейку точно, а не в ближайший к центру */
+    for (size_t i = n; i-- > 0;) {
+        uint16_t c = p->rgb565[i];
+        p->lut[((c >> 4) & 0xF00) | ((c >> 3) & 0x0F0) | ((c >> 1) & 0x00F)] = (uint8_t)i;
+    }
+}
+
+void fb_palette_encode(const fb_palette_t *p, uint8_t *dst, const uint16_t *src, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        dst[i] = fb_palette_index(p, src[i]);
+    }
+}
@@ -0,0 +1,47 @@
+/**
+ * @file fb_palette.h
+ * @brief Палитра 256 цветов для 8-битного фрейм-буфера
+ *
+ * Палитра строится из списка цветов UI: сами цвета, по три смеси каждого
+ * с фоном (сглаженные края текста и арки), равномерный куб 5x6x5 и серая
+ * шкала на оставшиеся места. Обратное преобразование RGB565 -> индекс идёт
+ * через таблицу 4096 байт по старшим 4 битам каждого канала; цвета UI
+ * в таблице прописаны точно.
+ *
+ * Модуль не зависит от ESP-IDF и LVGL и собирается на хосте.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define FB_PALETTE_SIZE         256
+#define FB_PALETTE_LUT_SIZE     4096
+#define FB_PALETTE_BLEND_STEPS  3
+#define FB_PALETTE_CUBE_SIZE    (5 * 6 * 5)
+
+/* Сколько цветов UI помещается рядом со смесями и кубом */
+#define FB_PALETTE_UI_MAX \
+    ((FB_PALETTE_SIZE - FB_PALETTE_CUBE_SIZE + FB_PALETTE_BLEND_STEPS) / (1 + FB_PALETTE_BLEND_STEPS))
+
+typedef struct {
+    uint16_t rgb565[FB_PALETTE_SIZE];
+    uint8_t lut[FB_PALETTE_LUT_SIZE];
+} fb_palette_t;
+
+/**
+ * @brief Построить палитру и обратную таблицу
+ * @param ui_colors цвета 0xRRGGBB, первый — фон
+ * @param n не больше FB_PALETTE_UI_MAX, лишние игнорируются
+ */
+void fb_palette_build(fb_palette_t *p, const uint32_t *ui_colors, size_t n);
+
+static inline uint8_t fb_palette_index(const fb_palette_t *p, uint16_t c)
+{
+    return p->lut[((c >> 4) & 0xF00) | ((c >> 3) & 0x0F0) | ((c >> 1) & 0x00F)];
+}
+
+/* RGB565 -> индексы, n пикселей */
+void fb_palette_encode(const fb_palette_t *p, uint8_t *dst, const uint16_t *src, size_t n);
+
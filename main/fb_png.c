@@ -0,0 +1,149 @@
+/**
+ * @file fb_png.c
+ * @brief PNG из RGB565: IHDR, один IDAT из несжатых deflate-блоков, IEND
+ */
+
+#include <stdlib.h>
+#include "fb_png.h"
+
+/* Наибольший несжатый блок deflate */
+#define PNG_STORED_MAX  65535u
+
+typedef struct {
+    FILE *f;
+    uint32_t crc;           /* CRC32 текущего чанка */
+    uint32_t adler_a;       /* Adler-32 несжатого потока */
+    uint32_t adler_b;
+    size_t raw_left;        /* несжатых байт до конца потока */
+    size_t block_left;      /* до конца текущего блока */
+    bool ok;
+} png_writer_t;
+
+static uint32_t crc_table[256];
+
+static void crc_table_init(void)
+{
+    if (crc_table[1] != 0) return;
+    for (uint32_t n = 0; n < 256; n++) {
+        uint32_t c = n;
+        for (int k = 0; k < 8; k++) {
+            c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        }
+        crc_table[n] = c;
+    }
+}
+
+static void put_be32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+/* Байты внутри чанка: в файл и в его CRC */
+static void out(png_writer_t *w, const uint8_t *data, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        w->crc = crc_table[(w->crc ^ data[i]) & 0xFF] ^ (w->crc >> 8);
+    }
+    w->ok = w->ok && fwrite(data, 1, n, w->f) == n;
+}
+
+static void chunk_begin(png_writer_t *w, const char *type, uint32_t len)
+{
+    uint8_t hdr[4];
+    put_be32(hdr, len);
+    w->ok = w->ok && fwrite(hdr, 1, sizeof(hdr), w->f) == sizeof(hdr);
+    w->crc = 0xFFFFFFFFu;
+    out(w, (const uint8_t *)type, 4);
+}
+
+static void chunk_end(png_writer_t *w)
+{
+    uint8_t tail[4];
+    put_be32(tail, w->crc ^ 0xFFFFFFFFu);
+    w->ok = w->ok && fwrite(tail, 1, sizeof(tail), w->f) == sizeof(tail);
+}
+
+/* Несжатые данные zlib-потока: режем на блоки, последний помечен BFINAL */
+static void deflate_put(png_writer_t *w, const uint8_t *data, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        w->adler_a = (w->adler_a + data[i]) % 65521u;
+        w->adler_b = (w->adler_b + w->adler_a) % 65521u;
+    }
+    while (n > 0) {
+        if (w->block_left == 0) {
+            size_t len = w->raw_left < PNG_STORED_MAX ? w->raw_left : PNG_STORED_MAX;
+            uint8_t hdr[5] = {
+                (uint8_t)(len == w->raw_left ? 1 : 0),
+                (uint8_t)len, (uint8_t)(len >> 8),
+                (uint8_t)~len, (uint8_t)(~len >> 8),
+            };
+            out(w, hdr, sizeof(hdr));
+            w->block_left = len;
+        }
+        size_t k = n < w->block_left ? n : w->block_left;
+        out(w, data, k);
+        data += k;
+        n -= k;
+        w->block_left -= k;
+        w->raw_left -= k;
+    }
+}
+
+bool fb_png_write(FILE *f, const uint16_t *fb, uint32_t w, uint32_t h, size_t stride_px)
+{
+    static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    size_t row_bytes = 1 + (size_t)w * 3;   /* байт фильтра (0 — без фильтра) и RGB */
+    size_t raw = row_bytes * h;
+    size_t blocks = (raw + PNG_STORED_MAX - 1) / PNG_STORED_MAX;
+    uint8_t *row = malloc(row_bytes);
+    if (w == 0 || h == 0 || row == NULL) {
+        free(row);
+        return false;
+    }
+
+    crc_table_init();
+    png_writer_t pw = { .f = f, .adler_a = 1, .raw_left = raw, .ok = true };
+    pw.ok = fwrite(signature, 1, sizeof(signature), f) == sizeof(signature);
+
+    uint8_t ihdr[13] = { 0 };
+    put_be32(ihdr, w);
+    put_be32(ihdr + 4, h);
+    ihdr[8] = 8;    /* бит на канал */
+    ihdr[9] = 2;    /* RGB */
+    chunk_begin(&pw, "IHDR", sizeof(ihdr));
+    out(&pw, ihdr, sizeof(ihdr));
+    chunk_end(&pw);
+
+    static const uint8_t zlib_hdr[2] = { 0x78, 0x01 };
+    chunk_begin(&pw, "IDAT", (uint32_t)(sizeof(zlib_hdr) + blocks * 5 + raw + 4));
+    out(&pw, zlib_hdr, sizeof(zlib_hdr));
+    for (uint32_t y = 0; y < h; y++) {
+        const uint16_t *src = fb + (size_t)y * stride_px;
+        uint8_t *p = row;
+        *p++ = 0;
+        for (uint32_t x = 0; x < w; x++) {
+            uint16_t c = src[x];
+            uint8_t r = (uint8_t)(c >> 11);
+            uint8_t g = (uint8_t)((c >> 5) & 0x3F);
+            uint8_t b = (uint8_t)(c & 0x1F);
+            *p++ = (uint8_t)((r << 3) | (r >> 2));
+            *p++ = (uint8_t)((g << 2) | (g >> 4));
+            *p++ = (uint8_t)((b << 3) | (b >> 2));
+        }
+        deflate_put(&pw, row, row_bytes);
+    }
+    uint8_t adler[4];
+    put_be32(adler, (pw.adler_b << 16) | pw.adler_a);
+    out(&pw, adler, sizeof(adler));
+    chunk_end(&pw);
+
+    chunk_begin(&pw, "IEND", 0);
+    chunk_end(&pw);
+
+    free(row);
+    return pw.ok;
+}
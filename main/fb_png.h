@@ -0,0 +1,23 @@
+/**
+ * @file fb_png.h
+ * @brief Снимок кадра RGB565 в PNG
+ *
+ * Без сжатия: deflate из несжатых блоков, кадр 480x480 — около 676 КБ.
+ * Цель — побайтно повторяемый файл для сравнения кадров, а не размер.
+ *
+ * Модуль не зависит от ESP-IDF и LVGL и собирается на хосте.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * @brief Записать кадр в PNG (RGB, 8 бит на канал)
+ * @param stride_px шаг строк fb в пикселях
+ * @return false — ошибка записи
+ */
+bool fb_png_write(FILE *f, const uint16_t *fb, uint32_t w, uint32_t h, size_t stride_px);
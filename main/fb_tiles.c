@@ -0,0 +1,137 @@
+/**
+ * @file fb_tiles.c
+ * @brief Хэширование тайлов и склейка изменившихся в прямоугольники
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include "fb_tiles.h"
+
+static inline int32_t max_i32(int32_t a, int32_t b) { return a > b ? a : b; }
+static inline int32_t min_i32(int32_t a, int32_t b) { return a < b ? a : b; }
+
+/* Быстрый мультипликативный хэш по 32-битным словам; строка тайла в RGB565
+ * занимает 64 байта, поэтому хвост встречается только у краевых тайлов */
+static uint32_t tile_hash(const uint8_t *p, size_t stride, size_t row_bytes, int32_t rows)
+{
+    uint32_t h = 0x811C9DC5u;
+    for (int32_t r = 0; r < rows; r++) {
+        const uint8_t *row = p + (size_t)r * stride;
+        size_t i = 0;
+        for (; i + 4 <= row_bytes; i += 4) {
+            uint32_t w;
+            memcpy(&w, row + i, sizeof(w));
+            h = (h ^ w) * 0x9E3779B1u;
+            h ^= h >> 15;
+        }
+        for (; i < row_bytes; i++) {
+            h = (h ^ row[i]) * 0x01000193u;
+        }
+    }
+    return h == FB_TILE_HASH_UNKNOWN ? 1u : h;
+}
+
+void fb_tiles_init(fb_tiles_t *t, uint32_t *hash, int32_t w, int32_t h, uint8_t px_size)
+{
+    t->hash = hash;
+    t->cols = (uint16_t)((w + FB_TILE_SIZE - 1) / FB_TILE_SIZE);
+    t->rows = (uint16_t)((h + FB_TILE_SIZE - 1) / FB_TILE_SIZE);
+    t->px_size = px_size;
+    t->skipped = 0;
+    t->written = 0;
+    fb_tiles_reset(t);
+}
+
+void fb_tiles_reset(fb_tiles_t *t)
+{
+    for (size_t i = 0; i < (size_t)t->cols * t->rows; i++) {
+        t->hash[i] = FB_TILE_HASH_UNKNOWN;
+    }
+}
+
+/* Добавить прямоугольник; если он продолжает по вертикали уже выданный
+ * прямоугольник с теми же x — просто удлинить тот */
+static size_t emit(fb_rect_t *out, size_t cnt, const fb_rect_t *r)
+{
+    for (size_t i = 0; i < cnt; i++) {
+        if (out[i].x1 == r->x1 && out[i].x2 == r->x2 && out[i].y2 + 1 == r->y1) {
+            out[i].y2 = r->y2;
+            return cnt;
+        }
+    }
+    out[cnt] = *r;
+    return cnt + 1;
+}
+
+size_t fb_tiles_filter(fb_tiles_t *t, const uint8_t *src, size_t src_stride, const fb_rect_t *area,
+                       fb_rect_t *out, size_t out_max)
+{
+    int32_t tx1 = area->x1 / FB_TILE_SIZE;
+    int32_t tx2 = area->x2 / FB_TILE_SIZE;
+    int32_t ty1 = area->y1 / FB_TILE_SIZE;
+    int32_t ty2 = area->y2 / FB_TILE_SIZE;
+    size_t cnt = 0;
+    bool overflow = false;
+
+    for (int32_t ty = ty1; ty <= ty2; ty++) {
+        int32_t y1 = max_i32(ty * FB_TILE_SIZE, area->y1);
+        int32_t y2 = min_i32(ty * FB_TILE_SIZE + FB_TILE_SIZE - 1, area->y2);
+        bool full_h = (y2 - y1 + 1) == FB_TILE_SIZE;
+        fb_rect_t run = { 0 };
+        bool in_run = false;
+
+        for (int32_t tx = tx1; tx <= tx2; tx++) {
+            int32_t x1 = max_i32(tx * FB_TILE_SIZE, area->x1);
+            int32_t x2 = min_i32(tx * FB_TILE_SIZE + FB_TILE_SIZE - 1, area->x2);
+            uint32_t *slot = &t->hash[(size_t)ty * t->cols + (size_t)tx];
+            bool changed = true;
+
+            if (full_h && (x2 - x1 + 1) == FB_TILE_SIZE) {
+                const uint8_t *p = src + (size_t)(y1 - area->y1) * src_stride
+                                 + (size_t)(x1 - area->x1) * t->px_size;
+                uint32_t h = tile_hash(p, src_stride, (size_t)FB_TILE_SIZE * t->px_size, FB_TILE_SIZE);
+                changed = (h != *slot);
+                *slot = h;
+            } else {
+                /* Частично покрытый тайл: хэш всего тайла неизвестен */
+                *slot = FB_TILE_HASH_UNKNOWN;
+            }
+
+            if (!changed) {
+                t->skipped++;
+                if (in_run) {
+                    if (cnt < out_max) {
+                        cnt = emit(out, cnt, &run);
+                    } else {
+                        overflow = true;
+                    }
+                    in_run = false;
+                }
+                continue;
+            }
+
+            t->written++;
+            if (in_run) {
+                run.x2 = x2;
+            } else {
+                run = (fb_rect_t){ x1, y1, x2, y2 };
+                in_run = true;
+            }
+        }
+        if (in_run) {
+            if (cnt < out_max) {
+                cnt = emit(out, cnt, &run);
+            } else {
+                overflow = true;
+            }
+        }
+    }
+
+    if (overflow) {
+        /* Не хватило места: записать всю область — это надмножество изменений,
+         * хэши уже соответствуют её содержимому */
+        out[0] = *area;
+        return 1;
+    }
+    return cnt;
+}
@@ -0,0 +1,53 @@
+/**
+ * @file fb_tiles.h
+ * @brief Пропуск неизменённых тайлов перед записью во фрейм-буфер
+ *
+ * Экран делится на тайлы FB_TILE_SIZE x FB_TILE_SIZE, для каждого хранится
+ * 32-битный хэш последнего записанного содержимого. Перед копированием
+ * отрисованной области тайлы, полностью покрытые областью и не изменившиеся,
+ * выбрасываются; остальные склеиваются в прямоугольники для fb_copy.
+ *
+ * Модуль не зависит от ESP-IDF и LVGL и собирается на хосте.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "fb_copy.h"
+
+#define FB_TILE_SIZE            32
+#define FB_TILE_HASH_UNKNOWN    0u
+
+typedef struct {
+    uint32_t *hash;         /* cols * rows хэшей, FB_TILE_HASH_UNKNOWN = записать обязательно */
+    uint16_t cols;
+    uint16_t rows;
+    uint8_t px_size;
+    uint32_t skipped;       /* тайлов не записано, потому что не изменились */
+    uint32_t written;       /* тайлов записано (включая частично покрытые) */
+} fb_tiles_t;
+
+/* Число хэшей для экрана w x h */
+#define FB_TILES_COUNT(w, h) \
+    ((((w) + FB_TILE_SIZE - 1) / FB_TILE_SIZE) * (((h) + FB_TILE_SIZE - 1) / FB_TILE_SIZE))
+
+/**
+ * @brief Инициализировать состояние. hash — массив на FB_TILES_COUNT(w, h)
+ * элементов; все тайлы помечаются неизвестными.
+ */
+void fb_tiles_init(fb_tiles_t *t, uint32_t *hash, int32_t w, int32_t h, uint8_t px_size);
+
+/* Забыть содержимое фрейм-буфера: следующий кадр запишется целиком */
+void fb_tiles_reset(fb_tiles_t *t);
+
+/**
+ * @brief Оставить от области только изменившиеся тайлы
+ * @param src буфер LVGL с отрисованной областью area
+ * @param src_stride байт на строку src
+ * @param out прямоугольники для записи (внутри area)
+ * @param out_max ёмкость out; при нехватке возвращается вся area одним прямоугольником
+ * @return число прямоугольников в out (0 — писать нечего)
+ */
+size_t fb_tiles_filter(fb_tiles_t *t, const uint8_t *src, size_t src_stride, const fb_rect_t *area,
+                       fb_rect_t *out, size_t out_max);
@@ -0,0 +1,51 @@
+/**
+ * @file gt911_bus.h
+ * @brief Доступ к регистрам GT911: I2C на устройстве, мок на хосте
+ *
+ * touch.c обращается к контроллеру только через read/write этой структуры,
+ * поэтому на хосте вместо шины можно подставить модель GT911 с записанными
+ * кадрами. Вызовы блокируют вызывающую задачу до конца транзакции, но не
+ * процессор: транзакцию на i2c_master ведёт прерывание драйвера, задача
+ * спит до её конца. Вызовы не потокобезопасны (у i2c-реализации один буфер
+ * адреса на шину) — touch.c сериализует их своим мьютексом.
+ *
+ * Сам интерфейс не зависит от ESP-IDF.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Самая длинная запись — конфиг GT911 (0x8047..0x80FF) */
+#define GT911_BUS_WRITE_MAX     192
+
+typedef struct gt911_bus gt911_bus_t;
+
+struct gt911_bus {
+    /* Прочитать len байт с регистра reg; false — NACK, ошибка или таймаут шины */
+    bool (*read)(gt911_bus_t *bus, uint16_t reg, uint8_t *data, size_t len);
+    /* Записать len байт (не больше GT911_BUS_WRITE_MAX) в регистр reg */
+    bool (*write)(gt911_bus_t *bus, uint16_t reg, const uint8_t *data, size_t len);
+};
+
+#ifdef ESP_PLATFORM
+/**
+ * @brief Шина на драйвере i2c_master (синхронный режим, таймаут 20 мс)
+ *
+ * Поднимает I2C-мастер и ищет GT911 по адресам 0x5D и 0x14.
+ * @return NULL, если шину не удалось поднять или контроллер не ответил
+ */
+gt911_bus_t *gt911_bus_i2c_create(int sda_io, int scl_io, uint32_t freq_hz);
+#endif
+
+/**
+ * @brief Модель GT911 для сборки под Linux
+ *
+ * Регистры в памяти: ID «911», конфиг 480x480. Кадры трассы (touch_trace.h)
+ * выставляются в 0x814E по своим меткам времени от первого опроса и
+ * снимаются записью нуля в статус, как у настоящего контроллера.
+ * @param trace_path файл трассы; NULL или ошибка чтения — касаний не будет
+ */
+gt911_bus_t *gt911_bus_sim_open(const char *trace_path);
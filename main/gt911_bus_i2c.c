@@ -0,0 +1,116 @@
+/**
+ * @file gt911_bus_i2c.c
+ * @brief gt911_bus_t на драйвере i2c_master
+ *
+ * Синхронный режим драйвера (trans_queue_depth = 0): транзакцию ведёт ISR
+ * драйвера, вызывающая задача спит внутри i2c_master_transmit*() до её
+ * конца или таймаута. Асинхронный режим здесь не годится: после таймаута
+ * драйвер ещё мог бы писать в буфер вызывающего, а опоздавший колбэк —
+ * завершить ожидание следующего вызова.
+ */
+
+#include <string.h>
+#include "gt911_bus.h"
+#include "driver/i2c_master.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static const char *TAG = "GT911";
+
+/* GT911 I2C addresses */
+#define GT911_I2C_ADDR_28   0x5D  /* Default address */
+#define GT911_I2C_ADDR_BA   0x14  /* Alternative address */
+
+#define GT911_BUS_PORT          I2C_NUM_0
+/* Кадр из 41 байта на 400 кГц идёт ~1 мс; дольше — шина повисла */
+#define GT911_BUS_TIMEOUT_MS    20
+
+typedef struct {
+    gt911_bus_t base;
+    i2c_master_bus_handle_t bus;
+    i2c_master_dev_handle_t dev;
+    /* Адрес регистра и данные записи */
+    uint8_t tx[2 + GT911_BUS_WRITE_MAX];
+} gt911_bus_i2c_t;
+
+static gt911_bus_i2c_t s_bus;
+
+/* Транзакция уже закончилась: по таймауту драйвер её прервал, шину сбрасываем */
+static bool gt911_bus_check(gt911_bus_i2c_t *b, esp_err_t ret)
+{
+    if (ret == ESP_ERR_TIMEOUT) {
+        ESP_LOGW(TAG, "I2C transaction timed out, resetting bus");
+        (void)i2c_master_bus_reset(b->bus);
+    }
+    return ret == ESP_OK;
+}
+
+static bool gt911_bus_read(gt911_bus_t *bus, uint16_t reg, uint8_t *data, size_t len)
+{
+    gt911_bus_i2c_t *b = (gt911_bus_i2c_t *)bus;
+    b->tx[0] = reg >> 8;
+    b->tx[1] = reg & 0xFF;
+    return gt911_bus_check(b, i2c_master_transmit_receive(b->dev, b->tx, 2, data, len, GT911_BUS_TIMEOUT_MS));
+}
+
+static bool gt911_bus_write(gt911_bus_t *bus, uint16_t reg, const uint8_t *data, size_t len)
+{
+    gt911_bus_i2c_t *b = (gt911_bus_i2c_t *)bus;
+    if (len > GT911_BUS_WRITE_MAX) {
+        return false;
+    }
+    b->tx[0] = reg >> 8;
+    b->tx[1] = reg & 0xFF;
+    if (len > 0) {
+        memcpy(b->tx + 2, data, len);
+    }
+    return gt911_bus_check(b, i2c_master_transmit(b->dev, b->tx, 2 + len, GT911_BUS_TIMEOUT_MS));
+}
+
+gt911_bus_t *gt911_bus_i2c_create(int sda_io, int scl_io, uint32_t freq_hz)
+{
+    gt911_bus_i2c_t *b = &s_bus;
+
+    i2c_master_bus_config_t bus_cfg = {
+        .i2c_port = GT911_BUS_PORT,
+        .sda_io_num = sda_io,
+        .scl_io_num = scl_io,
+        .clk_source = I2C_CLK_SRC_DEFAULT,
+        .glitch_ignore_cnt = 7,
+        .trans_queue_depth = 0,     /* синхронный режим */
+        .flags.enable_internal_pullup = true,
+    };
+    esp_err_t ret = i2c_new_master_bus(&bus_cfg, &b->bus);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "I2C bus init failed: %s", esp_err_to_name(ret));
+        return NULL;
+    }
+
+    /* Small delay for GT911 to stabilize */
+    vTaskDelay(pdMS_TO_TICKS(100));
+
+    uint16_t addr = GT911_I2C_ADDR_28;
+    if (i2c_master_probe(b->bus, addr, GT911_BUS_TIMEOUT_MS) != ESP_OK) {
+        ESP_LOGW(TAG, "Trying alternative I2C address...");
+        addr = GT911_I2C_ADDR_BA;
+        vTaskDelay(pdMS_TO_TICKS(50));
+        if (i2c_master_probe(b->bus, addr, GT911_BUS_TIMEOUT_MS) != ESP_OK) {
+            ESP_LOGE(TAG, "✗ GT911 not found on I2C bus");
+            i2c_del_master_bus(b->bus);
+            return NULL;
+        }
+    }
+
+    i2c_device_config_t dev_cfg = {
+        .dev_addr_length = I2C_ADDR_BIT_LEN_7,
+        .device_address = addr,
+        .scl_speed_hz = freq_hz,
+    };
+    ESP_ERROR_CHECK(i2c_master_bus_add_device(b->bus, &dev_cfg, &b->dev));
+
+    b->base.read = gt911_bus_read;
+    b->base.write = gt911_bus_write;
+    ESP_LOGI(TAG, "✓ GT911 detected at I2C addr 0x%02X", addr);
+    return &b->base;
+}
@@ -0,0 +1,164 @@
+/**
+ * @file gt911_bus_sim.c
+ * @brief Модель GT911 для сборки под Linux: регистры в памяти, касания из трассы
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "gt911_bus.h"
+#include "touch_trace.h"
+
+static const char *TAG = "GT911_SIM";
+
+/* Окно регистров 0x8040..0x817F: конфиг, ID, статус и точки */
+#define SIM_REG_BASE        0x8040
+#define SIM_REG_SIZE        0x0140
+#define SIM_REG_CONFIG      0x8047
+#define SIM_REG_CHKSUM      0x80FF
+#define SIM_REG_PRODUCT_ID  0x8140
+#define SIM_REG_STATUS      0x814E
+#define SIM_POINT_SIZE      8
+
+#define SIM_RES             480
+#define SIM_CFG_VERSION     0x41
+#define SIM_MAX_TRACE       (16 * 1024 * 1024)
+
+typedef struct {
+    gt911_bus_t bus;
+    uint8_t regs[SIM_REG_SIZE];
+    uint8_t *trace;
+    size_t len;
+    size_t pos;
+    int64_t t0_us;              /* первый опрос статуса — начало трассы */
+    touch_trace_frame_t next;
+    bool has_next;
+    uint32_t frames;
+} gt911_sim_t;
+
+static void sim_decode_next(gt911_sim_t *s)
+{
+    int64_t prev = s->next.t_us;
+    size_t n = s->trace ? touch_trace_decode(s->trace + s->pos, s->len - s->pos, prev, &s->next) : 0;
+    s->pos += n;
+    s->has_next = n > 0;
+}
+
+/* Выставить в статус кадр трассы, если подошло его время и прошлый снят */
+static void sim_present(gt911_sim_t *s)
+{
+    uint8_t *status = &s->regs[SIM_REG_STATUS - SIM_REG_BASE];
+    if (!s->has_next || (*status & 0x80)) return;
+    int64_t now = esp_timer_get_time();
+    if (s->t0_us == 0) s->t0_us = now;
+    if (now - s->t0_us < s->next.t_us) return;
+
+    uint8_t *p = status + 1;
+    for (uint8_t i = 0; i < s->next.count; i++, p += SIM_POINT_SIZE) {
+        const touch_contact_t *c = &s->next.contacts[i];
+        p[0] = c->id;
+        p[1] = (uint8_t)c->x;
+        p[2] = (uint8_t)((uint16_t)c->x >> 8);
+        p[3] = (uint8_t)c->y;
+        p[4] = (uint8_t)((uint16_t)c->y >> 8);
+        p[5] = (uint8_t)c->size;
+        p[6] = (uint8_t)(c->size >> 8);
+        p[7] = 0;
+    }
+    *status = (uint8_t)(0x80 | s->next.count);
+    s->frames++;
+    sim_decode_next(s);
+    if (!s->has_next) {
+        ESP_LOGI(TAG, "Trace finished: %u frames in %u ms", (unsigned)s->frames,
+                 (unsigned)((now - s->t0_us) / 1000));
+    }
+}
+
+static bool sim_in_window(uint16_t reg, size_t len)
+{
+    return reg >= SIM_REG_BASE && (size_t)(reg - SIM_REG_BASE) + len <= SIM_REG_SIZE;
+}
+
+static bool sim_read(gt911_bus_t *bus, uint16_t reg, uint8_t *data, size_t len)
+{
+    gt911_sim_t *s = (gt911_sim_t *)bus;
+    if (!sim_in_window(reg, len)) return false;
+    if (reg == SIM_REG_STATUS) {
+        sim_present(s);
+    }
+    memcpy(data, &s->regs[reg - SIM_REG_BASE], len);
+    return true;
+}
+
+/* Запись нуля в статус снимает кадр, как у контроллера */
+static bool sim_write(gt911_bus_t *bus, uint16_t reg, const uint8_t *data, size_t len)
+{
+    gt911_sim_t *s = (gt911_sim_t *)bus;
+    if (!sim_in_window(reg, len) || len > GT911_BUS_WRITE_MAX) return false;
+    memcpy(&s->regs[reg - SIM_REG_BASE], data, len);
+    return true;
+}
+
+static uint8_t *load_file(const char *path, size_t *len)
+{
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        ESP_LOGE(TAG, "Cannot open trace %s", path);
+        return NULL;
+    }
+    uint8_t *buf = NULL;
+    long size = -1;
+    if (fseek(f, 0, SEEK_END) == 0) size = ftell(f);
+    if (size > 0 && size <= SIM_MAX_TRACE && fseek(f, 0, SEEK_SET) == 0) {
+        buf = malloc((size_t)size);
+        if (buf && fread(buf, 1, (size_t)size, f) != (size_t)size) {
+            free(buf);
+            buf = NULL;
+        }
+    }
+    fclose(f);
+    if (buf == NULL || !touch_trace_check_header(buf, (size_t)size)) {
+        ESP_LOGE(TAG, "%s is not a touch trace", path);
+        free(buf);
+        return NULL;
+    }
+    *len = (size_t)size;
+    return buf;
+}
+
+gt911_bus_t *gt911_bus_sim_open(const char *trace_path)
+{
+    gt911_sim_t *s = calloc(1, sizeof(*s));
+    if (s == NULL) return NULL;
+    s->bus.read = sim_read;
+    s->bus.write = sim_write;
+
+    memcpy(&s->regs[SIM_REG_PRODUCT_ID - SIM_REG_BASE], "911", 4);
+    uint8_t *cfg = &s->regs[SIM_REG_CONFIG - SIM_REG_BASE];
+    cfg[0] = SIM_CFG_VERSION;
+    cfg[1] = (uint8_t)SIM_RES;
+    cfg[2] = (uint8_t)(SIM_RES >> 8);
+    cfg[3] = (uint8_t)SIM_RES;
+    cfg[4] = (uint8_t)(SIM_RES >> 8);
+    cfg[5] = TOUCH_TRACE_MAX_POINTS;
+    uint8_t sum = 0;
+    for (int i = 0; i < SIM_REG_CHKSUM - SIM_REG_CONFIG; i++) {
+        sum += cfg[i];
+    }
+    cfg[SIM_REG_CHKSUM - SIM_REG_CONFIG] = (uint8_t)(~sum + 1);
+
+    if (trace_path && trace_path[0]) {
+        s->trace = load_file(trace_path, &s->len);
+        if (s->trace) {
+            s->pos = TOUCH_TRACE_HEADER_SIZE;
+            sim_decode_next(s);
+            ESP_LOGI(TAG, "Playing %s (%u bytes)", trace_path, (unsigned)s->len);
+        }
+    }
+    if (s->trace == NULL) {
+        ESP_LOGI(TAG, "No touch trace, touch stays idle");
+    }
+    return &s->bus;
+}
@@ -0,0 +1,197 @@
+/**
+ * @file latency.c
+ * @brief Гистограммы задержки касание -> flush -> VSYNC
+ */
+
+#include "latency.h"
+
+#if CONFIG_LATENCY_STATS
+
+#include <stdio.h>
+#include <string.h>
+#include "esp_attr.h"
+#include "esp_console.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+
+static const char *TAG = "LATENCY";
+
+typedef struct {
+    uint32_t bucket[LATENCY_HIST_BUCKETS];
+    uint32_t count;
+    uint32_t min_us;
+    uint32_t max_us;
+} latency_hist_t;
+
+/* Отметки пишут задача LVGL и ISR (flush-done, VSYNC) */
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static int64_t s_input_us;      /* самый ранний отсчёт, ещё не попавший в рендер */
+static int64_t s_frame_us;      /* отсчёт кадра, который сейчас рисуется */
+static int64_t s_flushed_us;    /* отсчёт кадра, ждущего VSYNC */
+static latency_hist_t s_hist[LATENCY_STAGE_COUNT];
+
+static esp_timer_handle_t s_log_timer = NULL;
+
+static void IRAM_ATTR hist_add(latency_hist_t *h, int64_t dt_us)
+{
+    uint32_t us = dt_us > 0 ? (uint32_t)dt_us : 0;
+    uint32_t ms = us / 1000;
+    h->bucket[ms < LATENCY_HIST_BUCKETS ? ms : LATENCY_HIST_BUCKETS - 1]++;
+    if (h->count == 0 || us < h->min_us) h->min_us = us;
+    if (us > h->max_us) h->max_us = us;
+    h->count++;
+}
+
+/* Верхняя граница корзины, в которую попадает доля pct отсчётов */
+static uint32_t hist_percentile(const latency_hist_t *h, uint32_t pct)
+{
+    uint32_t rank = (h->count * pct + 99) / 100;
+    uint32_t acc = 0;
+    for (uint32_t i = 0; i < LATENCY_HIST_BUCKETS; i++) {
+        acc += h->bucket[i];
+        if (acc >= rank) {
+            return i + 1;
+        }
+    }
+    return LATENCY_HIST_BUCKETS;
+}
+
+void latency_input(int64_t t_us)
+{
+    portENTER_CRITICAL(&s_lock);
+    if (s_input_us == 0 || t_us < s_input_us) {
+        s_input_us = t_us;
+    }
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void latency_render_start(void)
+{
+    portENTER_CRITICAL(&s_lock);
+    /* Последняя полоса прошлого кадра ещё копируется — отсчёт подождёт
+     * следующего рендера, задержка выйдет оценкой сверху */
+    if (s_frame_us == 0) {
+        s_frame_us = s_input_us;
+        s_input_us = 0;
+    }
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void IRAM_ATTR latency_flush_done(void)
+{
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL_SAFE(&s_lock);
+    if (s_frame_us != 0) {
+        hist_add(&s_hist[LATENCY_STAGE_FLUSH], now - s_frame_us);
+        s_flushed_us = s_frame_us;
+        s_frame_us = 0;
+    }
+    portEXIT_CRITICAL_SAFE(&s_lock);
+}
+
+void IRAM_ATTR latency_vsync(void)
+{
+    if (s_flushed_us == 0) {
+        return;
+    }
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL_SAFE(&s_lock);
+    if (s_flushed_us != 0) {
+        hist_add(&s_hist[LATENCY_STAGE_SCANOUT], now - s_flushed_us);
+        s_flushed_us = 0;
+    }
+    portEXIT_CRITICAL_SAFE(&s_lock);
+}
+
+void latency_reset(void)
+{
+    portENTER_CRITICAL(&s_lock);
+    memset(s_hist, 0, sizeof(s_hist));
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void latency_get_summary(latency_stage_t stage, latency_summary_t *out)
+{
+    /* Копия, чтобы не считать процентили в критической секции. На стеке
+     * (~0.5 КБ): зовут и консоль, и таймер лога, общая копия их перемешала бы */
+    latency_hist_t h;
+    portENTER_CRITICAL(&s_lock);
+    h = s_hist[stage];
+    portEXIT_CRITICAL(&s_lock);
+
+    memset(out, 0, sizeof(*out));
+    out->count = h.count;
+    if (h.count == 0) {
+        return;
+    }
+    out->min_us = h.min_us;
+    out->max_us = h.max_us;
+    out->p50_ms = hist_percentile(&h, 50);
+    out->p95_ms = hist_percentile(&h, 95);
+    out->p99_ms = hist_percentile(&h, 99);
+}
+
+static void format_summary(char *buf, size_t len, latency_stage_t stage)
+{
+    latency_summary_t s;
+    latency_get_summary(stage, &s);
+    snprintf(buf, len, "n=%u p50<=%u p95<=%u p99<=%u ms (min %u.%u, max %u.%u)",
+             (unsigned)s.count, (unsigned)s.p50_ms, (unsigned)s.p95_ms, (unsigned)s.p99_ms,
+             (unsigned)(s.min_us / 1000), (unsigned)(s.min_us % 1000 / 100),
+             (unsigned)(s.max_us / 1000), (unsigned)(s.max_us % 1000 / 100));
+}
+
+static void latency_log_cb(void *arg)
+{
+    (void)arg;
+    char flush[96];
+    char scan[96];
+    format_summary(flush, sizeof(flush), LATENCY_STAGE_FLUSH);
+    format_summary(scan, sizeof(scan), LATENCY_STAGE_SCANOUT);
+    ESP_LOGI(TAG, "touch->flush %s; touch->vsync %s", flush, scan);
+}
+
+void latency_init(void)
+{
+#if CONFIG_LATENCY_LOG_PERIOD_S > 0
+    const esp_timer_create_args_t args = {
+        .callback = &latency_log_cb,
+        .arg = NULL,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "latency_log"
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&args, &s_log_timer));
+    ESP_ERROR_CHECK(esp_timer_start_periodic(s_log_timer, (uint64_t)CONFIG_LATENCY_LOG_PERIOD_S * 1000000));
+#else
+    (void)s_log_timer;
+    (void)latency_log_cb;
+#endif
+}
+
+static int latency_cmd(int argc, char **argv)
+{
+    if (argc > 1 && strcmp(argv[1], "reset") == 0) {
+        latency_reset();
+        return 0;
+    }
+    char buf[96];
+    format_summary(buf, sizeof(buf), LATENCY_STAGE_FLUSH);
+    printf("touch->flush  %s\n", buf);
+    format_summary(buf, sizeof(buf), LATENCY_STAGE_SCANOUT);
+    printf("touch->vsync  %s\n", buf);
+    return 0;
+}
+
+void latency_register_cmd(void)
+{
+    const esp_console_cmd_t cmd = {
+        .command = "latency",
+        .help = "Touch-to-photon latency percentiles; 'latency reset' clears them",
+        .hint = "[reset]",
+        .func = &latency_cmd,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&cmd));
+}
+
+#endif /* CONFIG_LATENCY_STATS */
@@ -0,0 +1,73 @@
+/**
+ * @file latency.h
+ * @brief Задержка от касания до пикселей на панели
+ *
+ * Путь отсчёта тача до экрана размечен так:
+ *  - GT911 прочитан — touch_sample_t.timestamp_us;
+ *  - UI изменился по этому отсчёту (арка, жест) — latency_input();
+ *  - LVGL начал рендер кадра — latency_render_start() забирает отсчёт в кадр;
+ *  - последняя область кадра записана во фрейм-буфер — latency_flush_done();
+ *  - следующий VSYNC, с него панель сканирует новый кадр — latency_vsync().
+ *
+ * Если до рендера накопилось несколько отсчётов, кадр меряется от самого
+ * раннего: его изменение впервые видно именно в этом кадре. Гистограммы
+ * «касание -> flush» и «касание -> VSYNC» с шагом 1 мс накапливаются
+ * до latency_reset().
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "sdkconfig.h"
+
+#define LATENCY_HIST_BUCKETS    128     /* 0..126 мс, последняя — всё, что дольше */
+
+typedef enum {
+    LATENCY_STAGE_FLUSH = 0,    /* касание -> кадр во фрейм-буфере */
+    LATENCY_STAGE_SCANOUT,      /* касание -> VSYNC после flush */
+    LATENCY_STAGE_COUNT,
+} latency_stage_t;
+
+typedef struct {
+    uint32_t count;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint32_t p50_ms;    /* верхние границы корзин */
+    uint32_t p95_ms;
+    uint32_t p99_ms;
+} latency_summary_t;
+
+#if CONFIG_LATENCY_STATS
+
+/* Периодический лог (CONFIG_LATENCY_LOG_PERIOD_S) */
+void latency_init(void);
+
+/* UI изменился по отсчёту тача с меткой t_us. Из задачи LVGL. */
+void latency_input(int64_t t_us);
+
+/* LV_EVENT_RENDER_START */
+void latency_render_start(void);
+
+/* Последняя область кадра во фрейм-буфере. Можно из ISR. */
+void latency_flush_done(void);
+
+/* VSYNC панели. Из ISR. */
+void latency_vsync(void);
+
+void latency_reset(void);
+void latency_get_summary(latency_stage_t stage, latency_summary_t *out);
+
+/* Команда консоли «latency [reset]» */
+void latency_register_cmd(void);
+
+#else
+
+static inline void latency_init(void) {}
+static inline void latency_input(int64_t t_us) { (void)t_us; }
+static inline void latency_render_start(void) {}
+static inline void latency_flush_done(void) {}
+static inline void latency_vsync(void) {}
+static inline void latency_reset(void) {}
+static inline void latency_register_cmd(void) {}
+
+#endif
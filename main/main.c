@@ -3,16 +3,25 @@
  * @brief Красивый экран термостата с круговым слайдером (GT911 + LVGL v9.4)
  */
 
+#include <stdatomic.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 #include "font/lv_font.h"
 #include "lvgl.h"
+#include "app_console.h"
 #include "display.h"
+#include "evtrace.h"
+#include "latency.h"
+#include "perf.h"
 #include "misc/lv_area.h"
 #include "touch.h"
+#include "touch_calib.h"
+#include "ui_bench.h"
+#include "ui_palette.h"
 #include "esp_log.h"
 #include "esp_system.h"
+#include "nvs_flash.h"
 
 static const char *TAG = "THERMOSTAT";
 
@@ -21,22 +30,65 @@ static lv_obj_t *label_room = NULL;
 static lv_obj_t *label_state = NULL;
 static lv_obj_t *arc = NULL;
 static lv_indev_t *touch_indev = NULL;
+/* Чтение индева уже стоит в очереди задачи LVGL */
+static atomic_bool touch_read_queued = false;
+
+/* Жесты приходят экрану событием с этим кодом, параметр — const touch_gesture_t * */
+static uint32_t touch_gesture_event = 0;
+static touch_gesture_rec_t gesture_rec;
+/* Жесты отсчётов, прочитанных одним lv_indev_read(): поворот копится,
+ * щипок заменяется последним, остальное идёт по порядку */
+#define GESTURE_QUEUE_LEN 4
+static touch_gesture_t gesture_queue[GESTURE_QUEUE_LEN];
+static int gesture_queued = 0;
+/* Доли градуса поворота, не дошедшие до уставки */
+static int32_t rotate_rest_ddeg = 0;
+/* Метка времени отсчёта, который индев отдал LVGL последним; 0 — уже учтён
+ * или кадр из воспроизведения трассы (в «fast» его метка в будущем) */
+static int64_t touch_input_us = 0;
 
 /* Температуры хранятся в десятых долях градуса, чтобы избежать float */
 static int32_t setpoint = 225; /* 22.5 °C */
 static int32_t room_temp = 215; /* 21.5 °C, будет анимироваться к setpoint */
 
+/* Что сейчас на подписях: текст и цвет ставим только при изменении, иначе
+ * LVGL перерисует их область впустую (ловит проверка T1_CHECK, ui_bench.h) */
+static int32_t shown_setpoint = INT32_MIN;
+static int32_t shown_room = INT32_MIN;
+static int shown_state = -1;
+
 static void update_labels(void)
 {
-    lv_label_set_text_fmt(label_set, "SET  %d.%d°C", (int16_t)setpoint / 10, (int16_t)setpoint % 10);
-    lv_label_set_text_fmt(label_room, "ROOM %d.%d°C", (int16_t)room_temp / 10, (int16_t)room_temp % 10);
+    uint32_t t0 = evtrace_now();
+    if (setpoint != shown_setpoint) {
+        shown_setpoint = setpoint;
+        lv_label_set_text_fmt(label_set, "SET  %d.%d°C", (int16_t)setpoint / 10, (int16_t)setpoint % 10);
+    }
+    if (room_temp != shown_room) {
+        shown_room = room_temp;
+        lv_label_set_text_fmt(label_room, "ROOM %d.%d°C", (int16_t)room_temp / 10, (int16_t)room_temp % 10);
+    }
 
     int diff = setpoint - room_temp;
-    const char *state = (diff > 5) ? "HEATING" : (diff < -5) ? "COOLING" : "HOLD";
-    lv_label_set_text_fmt(label_state, "%s", state);
-    lv_obj_set_style_text_color(label_state,
-        (diff > 5) ? lv_color_hex(0xff7a3d) : (diff < -5) ? lv_color_hex(0x00d1ff) : lv_color_hex(0x4ade80),
-        LV_PART_MAIN);
+    int state = (diff > 5) ? 0 : (diff < -5) ? 1 : 2;
+    if (state != shown_state) {
+        static const char *const names[] = { "HEATING", "COOLING", "HOLD" };
+        static const uint32_t colors[] = { UI_COLOR_HEAT, UI_COLOR_COOL, UI_COLOR_HOLD };
+        shown_state = state;
+        lv_label_set_text_static(label_state, names[state]);
+        lv_obj_set_style_text_color(label_state, lv_color_hex(colors[state]), LV_PART_MAIN);
+    }
+    evtrace_span(EVTRACE_UPDATE_LABELS, t0);
+}
+
+/* UI изменился: в гистограмму задержки — один раз на отсчёт и только от
+ * касания. Шаги ui_bench и прочие программные изменения идут без индева. */
+static void latency_touch_input(bool from_gesture)
+{
+    if (touch_input_us != 0 && (from_gesture || lv_indev_active() == touch_indev)) {
+        latency_input(touch_input_us);
+    }
+    touch_input_us = 0;
 }
 
 static void arc_event_cb(lv_event_t *e)
@@ -45,31 +97,118 @@ static void arc_event_cb(lv_event_t *e)
         int32_t v = lv_arc_get_value(arc); /* диапазон арки в десятых градуса */
         setpoint = v;
         update_labels();
+        latency_touch_input(false);
     }
 }
 
+/* Для сценариев ui_bench: обе температуры разом, вызывать под display_lock() */
+static void set_temps(int32_t new_setpoint, int32_t new_room)
+{
+    lv_arc_set_value(arc, new_setpoint);
+    setpoint = lv_arc_get_value(arc);
+    room_temp = new_room;
+    update_labels();
+}
+
 static void room_temp_timer_cb(lv_timer_t *timer)
 {
     (void)timer;
+    uint32_t t0 = evtrace_now();
     /* Простая динамика: стремимся к setpoint */
     if (room_temp < setpoint) room_temp++;
     else if (room_temp > setpoint) room_temp--;
     update_labels();
+    evtrace_span(EVTRACE_UI_TIMER, t0);
 }
 
-/* Touch → LVGL input */
+static void gesture_push(const touch_gesture_t *g)
+{
+    touch_gesture_t *last = gesture_queued ? &gesture_queue[gesture_queued - 1] : NULL;
+    if (last && last->type == g->type && g->type == TOUCH_GESTURE_ROTATE) {
+        int32_t angle = last->angle_ddeg + g->angle_ddeg;
+        *last = *g;
+        last->angle_ddeg = angle;
+    } else if (last && last->type == g->type && g->type == TOUCH_GESTURE_PINCH) {
+        *last = *g;
+    } else if (gesture_queued < GESTURE_QUEUE_LEN) {
+        gesture_queue[gesture_queued++] = *g;
+    } else {
+        ESP_LOGW(TAG, "gesture queue full, dropped %d", (int)g->type);
+    }
+}
+
+/* Touch → LVGL input: только забираем отсчёты задачи тача, I2C здесь нет */
 static void touchpad_read_cb(lv_indev_t *indev, lv_indev_data_t *data)
 {
     (void)indev;
-    int16_t xs[5], ys[5];
-    uint8_t cnt = 0;
-    bool pressed = touch_read_points(xs, ys, &cnt);
-    if (pressed && cnt > 0) {
-        data->state = LV_INDEV_STATE_PRESSED;
-        data->point.x = xs[0];
-        data->point.y = ys[0];
+    static touch_sample_t last = {0};
+    touch_sample_t sample;
+    if (touch_ring_pop(&sample)) {
+        last = sample;
+        touch_input_us = sample.replayed ? 0 : sample.timestamp_us;
+        data->continue_reading = touch_ring_count() > 0;
+        touch_gesture_t g;
+        if (touch_gesture_update(&gesture_rec, sample.timestamp_us, sample.contacts, sample.count, &g)) {
+            gesture_push(&g);
+        }
+    }
+    /* Второй палец — двухпальцевый жест: указатель отпускаем, чтобы арка не ехала вместе с ним */
+    data->state = (last.pressed && last.count < 2) ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
+    data->point.x = last.x;
+    data->point.y = last.y;
+}
+
+/* Задача LVGL: по lv_indev_read на каждый накопленный отсчёт, чтобы быстрый
+ * жест по арке не терял точки, пока рисовался тяжёлый кадр */
+static void touch_indev_read_async(void *arg)
+{
+    (void)arg;
+    atomic_store(&touch_read_queued, false);
+    do {
+        /* При continue_reading один вызов забирает несколько отсчётов */
+        lv_indev_read(touch_indev);
+        for (int i = 0; i < gesture_queued; i++) {
+            lv_obj_send_event(lv_screen_active(), (lv_event_code_t)touch_gesture_event, &gesture_queue[i]);
+        }
+        gesture_queued = 0;
+    } while (touch_ring_count() > 0);
+}
+
+/* Поворот двумя пальцами крутит уставку (1° — 0.1 °C), свайп вверх/вниз — на целый градус */
+static void screen_gesture_cb(lv_event_t *e)
+{
+    const touch_gesture_t *g = (const touch_gesture_t *)lv_event_get_param(e);
+    int32_t v = setpoint;
+    if (g->type == TOUCH_GESTURE_ROTATE) {
+        /* Медленный поворот приходит по 0.x°: остаток переносим, иначе он теряется */
+        int32_t ddeg = rotate_rest_ddeg + g->angle_ddeg;
+        rotate_rest_ddeg = ddeg % 10;
+        if (ddeg / 10 == 0) {
+            return;
+        }
+        v += ddeg / 10;
+    } else if (g->type == TOUCH_GESTURE_SWIPE && g->dir == TOUCH_SWIPE_UP) {
+        v += 10;
+    } else if (g->type == TOUCH_GESTURE_SWIPE && g->dir == TOUCH_SWIPE_DOWN) {
+        v -= 10;
     } else {
-        data->state = LV_INDEV_STATE_RELEASED;
+        return;
+    }
+    lv_arc_set_value(arc, v); /* арка сама ограничит диапазоном */
+    setpoint = lv_arc_get_value(arc);
+    update_labels();
+    /* Жесты шлёт touch_indev_read_async() после lv_indev_read(), индев уже не активен */
+    latency_touch_input(true);
+}
+
+/* Задача тача: в кольце новый отсчёт */
+static void touch_sample_cb(void *arg)
+{
+    (void)arg;
+    if (!atomic_exchange(&touch_read_queued, true)) {
+        if (!display_async_call(touch_indev_read_async, NULL)) {
+            atomic_store(&touch_read_queued, false);
+        }
     }
 }
 
@@ -78,9 +217,21 @@ void app_main(void)
     ESP_LOGI(TAG, "=== Thermostat UI ===");
     ESP_LOGI(TAG, "ESP-IDF: %s", esp_get_idf_version());
 
+    /* NVS: тень конфига GT911 */
+    esp_err_t ret = nvs_flash_init();
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        ret = nvs_flash_init();
+    }
+    ESP_ERROR_CHECK(ret);
+
+    latency_init();
+    evtrace_init();
+
     /* Инициализация дисплея ST7701 RGB 480x480 */
     display_init();
     ESP_LOGI(TAG, "Display initialized successfully");
+    perf_init();
 
     /* Инициализация тачпанели GT911 */
     if (!touch_init()) {
@@ -90,17 +241,18 @@ void app_main(void)
         touch_set_rotation(TOUCH_ROT_NORMAL);
     }
 
-    /* UI */
+    /* UI строим под блокировкой: задача LVGL уже запущена */
+    display_lock(DISPLAY_LOCK_FOREVER);
     lv_obj_t *scr = lv_screen_active();
 
     /* Фон с мягким градиентом */
-    lv_obj_set_style_bg_color(scr, lv_color_hex(0x0d1b2a), LV_PART_MAIN);
+    lv_obj_set_style_bg_color(scr, lv_color_hex(UI_COLOR_BG), LV_PART_MAIN);
     lv_obj_set_style_bg_opa(scr, LV_OPA_COVER, LV_PART_MAIN);
 
     /* Заголовок */
     lv_obj_t *title = lv_label_create(scr);
     lv_label_set_text(title, "Smart Thermostat");
-    lv_obj_set_style_text_color(title, lv_color_hex(0x00d1ff), LV_PART_MAIN);
+    lv_obj_set_style_text_color(title, lv_color_hex(UI_COLOR_COOL), LV_PART_MAIN);
     lv_obj_set_style_text_font(title, &lv_font_montserrat_24, LV_PART_MAIN);
     lv_obj_align(title, LV_ALIGN_TOP_MID, 0, 24);
 
@@ -114,56 +266,84 @@ void app_main(void)
     lv_arc_set_angles(arc, 135, 405);
     lv_obj_set_style_arc_width(arc, 24, LV_PART_MAIN);
     lv_obj_set_style_arc_width(arc, 24, LV_PART_INDICATOR);
-    lv_obj_set_style_arc_color(arc, lv_color_hex(0x1e293b), LV_PART_MAIN);
+    lv_obj_set_style_arc_color(arc, lv_color_hex(UI_COLOR_TRACK), LV_PART_MAIN);
 
     /* Кнопка (knob) тем же цветом, что и индикатор */
-    lv_obj_set_style_bg_color(arc, lv_color_hex(0x1e293b), LV_PART_KNOB);
+    lv_obj_set_style_bg_color(arc, lv_color_hex(UI_COLOR_TRACK), LV_PART_KNOB);
     lv_obj_set_style_bg_opa(arc, LV_OPA_COVER, LV_PART_KNOB);
     lv_obj_set_style_arc_opa(arc, LV_OPA_TRANSP, LV_PART_KNOB);
     lv_obj_set_style_border_width(arc, 3, LV_PART_KNOB);
-    lv_obj_set_style_border_color(arc, lv_color_hex(0xffffff), LV_PART_KNOB);
+    lv_obj_set_style_border_color(arc, lv_color_hex(UI_COLOR_TEXT), LV_PART_KNOB);
 
-    lv_obj_set_style_arc_color(arc, lv_color_hex(0x4ade80), LV_PART_INDICATOR);
+    lv_obj_set_style_arc_color(arc, lv_color_hex(UI_COLOR_HOLD), LV_PART_INDICATOR);
     lv_obj_set_style_arc_rounded(arc, true, LV_PART_INDICATOR);
     lv_obj_add_event_cb(arc, arc_event_cb, LV_EVENT_VALUE_CHANGED, NULL);
 
     /* Текущая/уставка */
     label_set = lv_label_create(scr);
     lv_obj_set_style_text_font(label_set, &lv_font_montserrat_26, LV_PART_MAIN);
-    lv_obj_set_style_text_color(label_set, lv_color_hex(0xffffff), LV_PART_MAIN);
+    lv_obj_set_style_text_color(label_set, lv_color_hex(UI_COLOR_TEXT), LV_PART_MAIN);
     lv_obj_align(label_set, LV_ALIGN_CENTER, 0, -4);
 
     label_room = lv_label_create(scr);
     lv_obj_set_style_text_font(label_room, &lv_font_montserrat_22, LV_PART_MAIN);
-    lv_obj_set_style_text_color(label_room, lv_color_hex(0x94a3b8), LV_PART_MAIN);
+    lv_obj_set_style_text_color(label_room, lv_color_hex(UI_COLOR_MUTED), LV_PART_MAIN);
     lv_obj_align(label_room, LV_ALIGN_CENTER, 0, 36);
 
     /* Статус (нагрев/охлаждение/поддержание) */
     label_state = lv_label_create(scr);
     lv_obj_set_style_text_font(label_state, &lv_font_montserrat_20, LV_PART_MAIN);
-    lv_obj_set_style_text_color(label_state, lv_color_hex(0x4ade80), LV_PART_MAIN);
+    lv_obj_set_style_text_color(label_state, lv_color_hex(UI_COLOR_HOLD), LV_PART_MAIN);
     lv_obj_align(label_state, LV_ALIGN_BOTTOM_MID, 0, -60);
 
     /* Нижняя подпись */
     lv_obj_t *footer = lv_label_create(scr);
     lv_label_set_text(footer, "Touch to set temperature");
-    lv_obj_set_style_text_color(footer, lv_color_hex(0x64748b), LV_PART_MAIN);
+    lv_obj_set_style_text_color(footer, lv_color_hex(UI_COLOR_FOOTER), LV_PART_MAIN);
     lv_obj_set_style_text_font(footer, &lv_font_montserrat_14, LV_PART_MAIN);
     lv_obj_align(footer, LV_ALIGN_BOTTOM_MID, 0, -24);
 
+    /* Жесты двумя пальцами — событием на экран */
+    touch_gesture_init(&gesture_rec);
+    touch_gesture_event = lv_event_register_id();
+    lv_obj_add_event_cb(scr, screen_gesture_cb, (lv_event_code_t)touch_gesture_event, NULL);
+
     /* Input device для LVGL */
     touch_indev = lv_indev_create();
     lv_indev_set_type(touch_indev, LV_INDEV_TYPE_POINTER);
     lv_indev_set_read_cb(touch_indev, touchpad_read_cb);
+    /* Индев читается по событию от задачи тача, таймер LVGL его не опрашивает */
+    if (touch_task_start(touch_sample_cb, NULL)) {
+        lv_indev_set_mode(touch_indev, LV_INDEV_MODE_EVENT);
+    } else {
+        ESP_LOGE(TAG, "Touch task not started, input disabled");
+    }
 
     /* Таймер для плавного изменения «комнатной» температуры */
-    lv_timer_create(room_temp_timer_cb, 300, NULL);
+    lv_timer_t *room_timer = lv_timer_create(room_temp_timer_cb, 300, NULL);
 
     /* Устанавливаем яркость подсветки */
     display_set_brightness(90);
 
     /* Первичное обновление UI */
     update_labels();
+#if CONFIG_TOUCH_CALIBRATE_AT_BOOT
+    if (!touch_is_calibrated()) {
+        touch_calib_start();
+    }
+#endif
+    display_unlock();
+
+    const ui_bench_target_t bench = {
+        .arc = arc,
+        .label_set = label_set,
+        .label_room = label_room,
+        .label_state = label_state,
+        .room_timer = room_timer,
+        .set_temps = set_temps,
+    };
+    ui_bench_init(&bench);
+    app_console_start();
 
     ESP_LOGI(TAG, "Thermostat UI ready. Rotate arc (touch) to change setpoint.");
 }
@@ -0,0 +1,197 @@
+/**
+ * @file perf.c
+ * @brief Сводка производительности за интервал, лог и команда консоли
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "sdkconfig.h"
+#if CONFIG_APP_CONSOLE
+#include "esp_console.h"
+#endif
+#if !CONFIG_IDF_TARGET_LINUX
+#include "esp_heap_caps.h"
+#endif
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "perf.h"
+
+static const char *TAG = "PERF";
+
+#define PERF_LINE_MAX   192
+
+_Static_assert(PERF_CORES == DISPLAY_DRAW_CORES, "one draw thread per core");
+
+/* Верхняя граница корзины, в которую попадает доля pct кадров интервала */
+static uint32_t hist_percentile(const uint32_t *now, const uint32_t *prev, uint32_t total, uint32_t pct)
+{
+    uint32_t rank = (total * pct + 99) / 100;
+    uint32_t acc = 0;
+    for (uint32_t i = 0; i < DISPLAY_RENDER_HIST_BUCKETS; i++) {
+        acc += now[i] - prev[i];
+        if (acc >= rank) {
+            return i + 1;
+        }
+    }
+    return DISPLAY_RENDER_HIST_BUCKETS;
+}
+
+static uint32_t hist_max(const uint32_t *now, const uint32_t *prev)
+{
+    for (uint32_t i = DISPLAY_RENDER_HIST_BUCKETS; i-- > 0;) {
+        if (now[i] != prev[i]) {
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+void perf_window_read(perf_window_t *w, perf_report_t *out)
+{
+    perf_window_t cur;
+    cur.t_us = esp_timer_get_time();
+    display_get_frame_stats(&cur.frames);
+
+    memset(out, 0, sizeof(*out));
+    /* Окно от запуска или между редкими «perf» бывает длиннее 71 минуты */
+    uint64_t period_us = (uint64_t)(cur.t_us - w->t_us);
+    /* Счётчики времени задач — uint32 в мкс: за такое окно могли обернуться не раз */
+    bool counters_ok = period_us <= UINT32_MAX;
+    uint32_t frames = cur.frames.frames - w->frames.frames;
+    out->period_ms = (uint32_t)(period_us / 1000);
+    out->frames = frames;
+    out->fps_x10 = period_us ? (uint32_t)((uint64_t)frames * 10000000u / period_us) : 0;
+    if (frames) {
+        out->render_avg_us = (uint32_t)((cur.frames.render_us - w->frames.render_us) / frames);
+        out->flush_avg_us = (uint32_t)((cur.frames.flush_us - w->frames.flush_us) / frames);
+        out->inv_px_avg = (uint32_t)((cur.frames.inv_px - w->frames.inv_px) / frames);
+        out->render_p95_ms = hist_percentile(cur.frames.render_hist, w->frames.render_hist, frames, 95);
+        out->render_max_ms = hist_max(cur.frames.render_hist, w->frames.render_hist);
+    }
+
+    /* Загрузка ядра = всё, что не idle-задача. Счётчики FreeRTOS идут от
+     * esp_timer в микросекундах, переполнение uint32 снимает беззнаковая разность. */
+    for (int core = 0; core < PERF_CORES; core++) {
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+        if (core >= portNUM_PROCESSORS) {
+            cur.idle_us[core] = 0;
+            out->busy_pct[core] = -1;
+            continue;
+        }
+        cur.idle_us[core] = ulTaskGetRunTimeCounter(xTaskGetIdleTaskHandleForCore(core));
+        if (!counters_ok) {
+            out->busy_pct[core] = -1;
+            continue;
+        }
+        uint32_t idle_delta = cur.idle_us[core] - w->idle_us[core];
+        if (idle_delta > period_us) idle_delta = period_us;
+        out->busy_pct[core] = (int8_t)(period_us ? (period_us - idle_delta) * 100u / period_us : 0);
+#else
+        cur.idle_us[core] = 0;
+        out->busy_pct[core] = -1;
+#endif
+    }
+
+    /* Время рендера по ядрам: сколько работал поток рисования, привязанный к ядру */
+    bool have_draw = display_get_draw_time(cur.draw_us);
+    for (int core = 0; core < PERF_CORES; core++) {
+        if (!have_draw) {
+            cur.draw_us[core] = 0;
+            out->draw_avg_us[core] = -1;
+        } else if (!counters_ok) {
+            out->draw_avg_us[core] = -1;
+        } else {
+            out->draw_avg_us[core] = frames ? (int32_t)((cur.draw_us[core] - w->draw_us[core]) / frames) : 0;
+        }
+    }
+
+#if !CONFIG_IDF_TARGET_LINUX
+    out->internal_free = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    out->internal_min = heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL);
+    out->psram_free = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+    out->psram_min = heap_caps_get_minimum_free_size(MALLOC_CAP_SPIRAM);
+#endif
+
+    *w = cur;
+}
+
+int perf_format(char *buf, size_t len, const perf_report_t *r)
+{
+    return snprintf(buf, len,
+                    "t=%u fps=%u.%u r=%u/%u/%u f=%u inv=%u cpu=%d,%d draw=%d,%d int=%u/%u ps=%u/%u",
+                    (unsigned)r->period_ms, (unsigned)(r->fps_x10 / 10), (unsigned)(r->fps_x10 % 10),
+                    (unsigned)r->render_avg_us, (unsigned)r->render_p95_ms, (unsigned)r->render_max_ms,
+                    (unsigned)r->flush_avg_us, (unsigned)r->inv_px_avg,
+                    r->busy_pct[0], r->busy_pct[1],
+                    (int)r->draw_avg_us[0], (int)r->draw_avg_us[1],
+                    (unsigned)r->internal_free, (unsigned)r->internal_min,
+                    (unsigned)r->psram_free, (unsigned)r->psram_min);
+}
+
+#if CONFIG_DISPLAY_RENDER_STATS
+/* В задаче esp_timer, а не LVGL: печать не удлиняет кадр */
+static void perf_log_cb(void *arg)
+{
+    static perf_window_t window;
+    char line[PERF_LINE_MAX];
+    perf_report_t r;
+    (void)arg;
+    perf_window_read(&window, &r);
+    perf_format(line, sizeof(line), &r);
+    ESP_LOGI(TAG, "%s", line);
+}
+#endif
+
+void perf_init(void)
+{
+#if CONFIG_DISPLAY_RENDER_STATS
+    static esp_timer_handle_t timer = NULL;
+    const esp_timer_create_args_t args = {
+        .callback = &perf_log_cb,
+        .arg = NULL,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "perf_log"
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&args, &timer));
+    ESP_ERROR_CHECK(esp_timer_start_periodic(timer, (uint64_t)CONFIG_DISPLAY_RENDER_STATS_PERIOD_S * 1000000));
+#endif
+}
+
+#if CONFIG_APP_CONSOLE
+static int perf_cmd(int argc, char **argv)
+{
+    static perf_window_t window;
+    perf_report_t r;
+    (void)argc;
+    (void)argv;
+    perf_window_read(&window, &r);
+    printf("since last 'perf': %u ms, %u frames, %u.%u fps\n", (unsigned)r.period_ms, (unsigned)r.frames,
+           (unsigned)(r.fps_x10 / 10), (unsigned)(r.fps_x10 % 10));
+    printf("render: avg %u us, p95 <= %u ms, max <= %u ms; flush avg %u us/frame\n",
+           (unsigned)r.render_avg_us, (unsigned)r.render_p95_ms, (unsigned)r.render_max_ms,
+           (unsigned)r.flush_avg_us);
+    printf("invalidated: %u px/frame\n", (unsigned)r.inv_px_avg);
+    printf("cpu busy: core0 %d%%, core1 %d%%\n", r.busy_pct[0], r.busy_pct[1]);
+    if (r.draw_avg_us[0] >= 0) {
+        printf("draw threads: core0 %d us/frame, core1 %d us/frame\n",
+               (int)r.draw_avg_us[0], (int)r.draw_avg_us[1]);
+    }
+    printf("heap internal: %u free, %u min; psram: %u free, %u min\n",
+           (unsigned)r.internal_free, (unsigned)r.internal_min, (unsigned)r.psram_free, (unsigned)r.psram_min);
+    return 0;
+}
+
+void perf_register_cmd(void)
+{
+    const esp_console_cmd_t cmd = {
+        .command = "perf",
+        .help = "Frame timing, flush time, invalidated area, CPU load and heap since the previous 'perf'",
+        .hint = NULL,
+        .func = &perf_cmd,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&cmd));
+}
+
+#endif /* CONFIG_APP_CONSOLE */
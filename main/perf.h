@@ -0,0 +1,54 @@
+/**
+ * @file perf.h
+ * @brief Сводка производительности: кадры, вывод, загрузка ядер, кучи
+ *
+ * Счётчики копятся всегда (display_get_frame_stats(), run-time stats
+ * FreeRTOS, статистика куч), сводка за интервал считается только при
+ * чтении. У каждого читателя своё окно perf_window_t: консоль и
+ * периодический лог не сбивают друг другу интервалы.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "display.h"
+
+#define PERF_CORES  2
+
+/* Состояние читателя на начало интервала; нулевое — интервал от запуска */
+typedef struct {
+    int64_t t_us;
+    display_frame_stats_t frames;
+    uint32_t idle_us[PERF_CORES];
+    uint32_t draw_us[PERF_CORES];
+} perf_window_t;
+
+typedef struct {
+    uint32_t period_ms;
+    uint32_t frames;
+    uint32_t fps_x10;
+    uint32_t render_avg_us;
+    uint32_t render_p95_ms;         /* верхние границы корзин по 1 мс */
+    uint32_t render_max_ms;
+    uint32_t flush_avg_us;          /* на кадр */
+    uint32_t inv_px_avg;            /* на кадр */
+    int8_t busy_pct[PERF_CORES];    /* -1 — run-time stats FreeRTOS выключены, ядра нет или окно > 71 мин */
+    int32_t draw_avg_us[PERF_CORES]; /* поток рисования ядра, на кадр; -1 — нет данных */
+    size_t internal_free;           /* кучи ESP-IDF; на хосте нули */
+    size_t internal_min;            /* минимум свободной с запуска */
+    size_t psram_free;
+    size_t psram_min;
+} perf_report_t;
+
+/* Сводка с начала окна; окно начинается заново с текущего момента */
+void perf_window_read(perf_window_t *w, perf_report_t *out);
+
+/* Одна строка key=value для лога и консоли */
+int perf_format(char *buf, size_t len, const perf_report_t *r);
+
+/* Периодический лог (CONFIG_DISPLAY_RENDER_STATS) */
+void perf_init(void);
+
+/* Команда консоли «perf» (CONFIG_APP_CONSOLE) */
+void perf_register_cmd(void);
@@ -6,18 +6,29 @@
  * Использует ту же логику что и TAMC_GT911 библиотека
  */
 
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
 #include "touch.h"
-#include "driver/i2c.h"
+#include "gt911_bus.h"
+#include "evtrace.h"
+#include "touch_affine.h"
+#include "touch_filter.h"
+#include "touch_trace.h"
+#if TOUCH_GT911_INT >= 0
+#include "driver/gpio.h"
+#endif
+#include "esp_attr.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
 
 static const char *TAG = "GT911";
 
-/* GT911 I2C addresses */
-#define GT911_I2C_ADDR_28   0x5D  /* Default address */
-#define GT911_I2C_ADDR_BA   0x14  /* Alternative address */
-
 /* GT911 Registers */
 #define GT911_REG_PRODUCT_ID    0x8140
 #define GT911_REG_CONFIG        0x8047
@@ -25,85 +36,167 @@ static const char *TAG = "GT911";
 #define GT911_REG_DATA          0x814F
 #define GT911_REG_CONFIG_CHKSUM 0x80FF
 #define GT911_REG_CONFIG_FRESH  0x8100
+#define GT911_REG_MODULE_SW1    0x804D  /* биты 0..1: как контроллер дёргает INT */
+
+#define GT911_CONFIG_SIZE       (0xFF - 0x46) /* 0x8047..0x80FF, с контрольной суммой */
+
+/* Поля конфига: смещения от GT911_REG_CONFIG */
+#define GT911_CFG_VERSION       0x00
+#define GT911_CFG_X_MAX         0x01    /* 16 бит, little-endian */
+#define GT911_CFG_Y_MAX         0x03
+#define GT911_CFG_FILTER        0x09    /* биты 0..5 */
+#define GT911_CFG_TOUCH_LEVEL   0x0C
+#define GT911_CFG_LEAVE_LEVEL   0x0D
+#define GT911_CFG_REFRESH_RATE  0x0F    /* биты 0..3: период отчёта 5 + N мс */
+#define GT911_CFG_CHKSUM        (GT911_REG_CONFIG_CHKSUM - GT911_REG_CONFIG)
+
+/* Тень конфига в NVS: по ней загрузка не читает 185 байт из контроллера */
+#define TOUCH_NVS_NAMESPACE     "touch"
+#define TOUCH_NVS_KEY_SHADOW    "gt911_cfg"
+#define TOUCH_NVS_KEY_CALIB     "calib"
+_Static_assert(GT911_CONFIG_SIZE <= GT911_BUS_WRITE_MAX, "GT911 config must fit one bus write");
+
+/* Кадр с 0x814E: байт статуса и по 8 байт на точку (id, X, Y, размер, резерв) */
+#define GT911_MAX_POINTS        TOUCH_MAX_POINTS
+#define GT911_POINT_SIZE        8
+#define GT911_FRAME_SIZE        (1 + GT911_MAX_POINTS * GT911_POINT_SIZE)
+_Static_assert(TOUCH_TRACE_MAX_POINTS == GT911_MAX_POINTS, "trace frame must hold a full GT911 frame");
 
-#define GT911_CONFIG_SIZE       (0xFF - 0x46) /* как в Arduino Touch_GT911 */
-
-#define I2C_MASTER_NUM      I2C_NUM_0
 #define I2C_MASTER_FREQ_HZ  400000
-#define I2C_MASTER_TIMEOUT  1000
+
+#define TOUCH_BENCH_ITERATIONS  200
+
+/* Частота среза для оценки скорости в One-Euro, мГц */
+#define TOUCH_FILTER_D_CUTOFF_MHZ   1000
+
+/* Задача опроса: выше LVGL, чтобы тяжёлый кадр не задерживал чтение касаний */
+#define TOUCH_TASK_PRIO         6
+#define TOUCH_TASK_STACK        4096
 
 /* Global touch coordinates (для совместимости старого API) */
 int16_t touch_last_x = 0;
 int16_t touch_last_y = 0;
 
 /* Internal state */
-static uint8_t gt911_addr = GT911_I2C_ADDR_28;
+static gt911_bus_t *bus = NULL;
 static bool initialized = false;
 static uint8_t rotation = TOUCH_ROT_NORMAL;
 static uint16_t panel_w = TOUCH_MAX_X;
 static uint16_t panel_h = TOUCH_MAX_Y;
+/* Действующая матрица: меняется из консоли и калибровки, задача тача
+ * копирует её под спинлоком (шесть слов — короче любого ожидания) */
+static touch_affine_t xform = { .a = TOUCH_AFFINE_ONE, .e = TOUCH_AFFINE_ONE };
+static portMUX_TYPE xform_lock = portMUX_INITIALIZER_UNLOCKED;
+static touch_affine_t calib;
+static bool calibrated = false;
+static volatile bool raw_mode = false;
 static uint8_t config_buf[GT911_CONFIG_SIZE] = {0};
-
-/* Map function как в Arduino */
-static int16_t map_value(int16_t x, int16_t in_min, int16_t in_max, int16_t out_min, int16_t out_max)
+static bool config_valid = false;
+/* Шина GT911 (у i2c-реализации общий буфер адреса) и config_buf: задача тача
+ * читает кадры, настройки пишут из других задач. Рекурсивный — запись
+ * конфига держит его на всё чтение-изменение-запись. */
+static SemaphoreHandle_t bus_lock = NULL;
+/* Сколько точек читать одним куском со статусом: столько же, сколько было в прошлом кадре */
+static uint8_t burst_points = 1;
+static TaskHandle_t sample_task = NULL;
+static volatile bool irq_mode = false;
+static void (*sample_cb)(void *arg) = NULL;
+static void *sample_cb_arg = NULL;
+/* Запись трассы: сырой кадр отдаётся сюда из задачи тача */
+static void (*frame_hook)(const touch_trace_frame_t *f) = NULL;
+/* Воспроизведение: кадры приходят из очереди вместо GT911 */
+static QueueHandle_t inject_queue = NULL;
+static volatile bool replay = false;
+static atomic_bool source_changed;
+
+/* Кольцо отсчётов: пишет только задача тача, читает только задача LVGL */
+static touch_sample_t ring[TOUCH_RING_SIZE];
+static atomic_uint_least32_t ring_head;  /* двигает производитель */
+static atomic_uint_least32_t ring_tail;  /* двигает потребитель */
+static volatile uint32_t ring_pushed = 0;
+static volatile uint32_t ring_overruns = 0;
+
+/* Дополнение до нуля суммы 0x8047..0x80FE */
+static uint8_t config_checksum(const uint8_t *cfg)
 {
-    if (in_max == in_min) return out_min;
-    return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+    uint8_t checksum = 0;
+    for (uint16_t i = 0; i < GT911_CFG_CHKSUM; i++) {
+        checksum += cfg[i];
+    }
+    return (uint8_t)((~checksum) + 1);
 }
 
-static void calc_checksum_and_mark_fresh(void)
+static uint32_t config_hash(const uint8_t *cfg)
 {
-    uint8_t checksum = 0;
+    uint32_t h = 2166136261u; /* FNV-1a */
     for (uint16_t i = 0; i < GT911_CONFIG_SIZE; i++) {
-        checksum += config_buf[i];
+        h = (h ^ cfg[i]) * 16777619u;
     }
-    checksum = (uint8_t)((~checksum) + 1);
-    config_buf[GT911_REG_CONFIG_CHKSUM - GT911_REG_CONFIG] = checksum;
-    config_buf[GT911_REG_CONFIG_FRESH - GT911_REG_CONFIG] = 1;
+    return h;
 }
 
-static void apply_rotation(uint16_t *x, uint16_t *y)
+/* Поворот как в Arduino Touch_GT911, в виде матрицы */
+static void rotation_matrix(touch_affine_t *m)
 {
-    uint16_t x0 = *x;
-    uint16_t y0 = *y;
+    const int32_t one = TOUCH_AFFINE_ONE;
+    const int32_t w = (int32_t)panel_w * one;
+    const int32_t h = (int32_t)panel_h * one;
     switch (rotation) {
-        case TOUCH_ROT_LEFT:
-            *x = panel_w - y0;
-            *y = x0;
+        case TOUCH_ROT_LEFT:        /* x = w - y, y = x */
+            *m = (touch_affine_t){ .b = -one, .c = w, .d = one };
             break;
-        case TOUCH_ROT_INVERTED:
-            *x = panel_w - x0;
-            *y = panel_h - y0;
+        case TOUCH_ROT_INVERTED:    /* x = w - x, y = h - y */
+            *m = (touch_affine_t){ .a = -one, .c = w, .e = -one, .f = h };
             break;
-        case TOUCH_ROT_RIGHT:
-            *x = y0;
-            *y = panel_h - x0;
+        case TOUCH_ROT_RIGHT:       /* x = y, y = h - x */
+            *m = (touch_affine_t){ .b = one, .d = -one, .f = h };
             break;
         case TOUCH_ROT_NORMAL:
         default:
-            *x = x0;
-            *y = y0;
+            touch_affine_identity(m);
             break;
     }
 }
 
+/* Выбрать матрицу (сырые координаты, калибровка или поворот) и отдать задаче тача */
+static void xform_update(void)
+{
+    touch_affine_t m;
+    if (raw_mode) {
+        touch_affine_identity(&m);
+    } else if (calibrated) {
+        m = calib;
+    } else {
+        rotation_matrix(&m);
+    }
+    portENTER_CRITICAL(&xform_lock);
+    xform = m;
+    portEXIT_CRITICAL(&xform_lock);
+}
+
+static void calib_load(void)
+{
+    nvs_handle_t nvs;
+    if (nvs_open(TOUCH_NVS_NAMESPACE, NVS_READONLY, &nvs) != ESP_OK) {
+        return;
+    }
+    size_t len = sizeof(calib);
+    if (nvs_get_blob(nvs, TOUCH_NVS_KEY_CALIB, &calib, &len) == ESP_OK && len == sizeof(calib)) {
+        calibrated = true;
+        ESP_LOGI(TAG, "Calibration loaded from NVS");
+    }
+    nvs_close(nvs);
+}
+
 /**
  * @brief Write data to GT911 register
  */
 static esp_err_t gt911_write_reg(uint16_t reg, uint8_t *data, size_t len)
 {
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-    i2c_master_start(cmd);
-    i2c_master_write_byte(cmd, (gt911_addr << 1) | I2C_MASTER_WRITE, true);
-    i2c_master_write_byte(cmd, reg >> 8, true);
-    i2c_master_write_byte(cmd, reg & 0xFF, true);
-    if (len > 0) {
-        i2c_master_write(cmd, data, len, true);
-    }
-    i2c_master_stop(cmd);
-    esp_err_t ret = i2c_master_cmd_begin(I2C_MASTER_NUM, cmd, pdMS_TO_TICKS(I2C_MASTER_TIMEOUT));
-    i2c_cmd_link_delete(cmd);
-    return ret;
+    (void)xSemaphoreTakeRecursive(bus_lock, portMAX_DELAY);
+    bool ok = bus->write(bus, reg, data, len);
+    (void)xSemaphoreGiveRecursive(bus_lock);
+    return ok ? ESP_OK : ESP_FAIL;
 }
 
 /**
@@ -111,79 +204,150 @@ static esp_err_t gt911_write_reg(uint16_t reg, uint8_t *data, size_t len)
  */
 static esp_err_t gt911_read_reg(uint16_t reg, uint8_t *data, size_t len)
 {
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-    i2c_master_start(cmd);
-    i2c_master_write_byte(cmd, (gt911_addr << 1) | I2C_MASTER_WRITE, true);
-    i2c_master_write_byte(cmd, reg >> 8, true);
-    i2c_master_write_byte(cmd, reg & 0xFF, true);
-    i2c_master_start(cmd);
-    i2c_master_write_byte(cmd, (gt911_addr << 1) | I2C_MASTER_READ, true);
-    if (len > 1) {
-        i2c_master_read(cmd, data, len - 1, I2C_MASTER_ACK);
-    }
-    i2c_master_read_byte(cmd, data + len - 1, I2C_MASTER_NACK);
-    i2c_master_stop(cmd);
-    esp_err_t ret = i2c_master_cmd_begin(I2C_MASTER_NUM, cmd, pdMS_TO_TICKS(I2C_MASTER_TIMEOUT));
-    i2c_cmd_link_delete(cmd);
-    return ret;
+    (void)xSemaphoreTakeRecursive(bus_lock, portMAX_DELAY);
+    bool ok = bus->read(bus, reg, data, len);
+    (void)xSemaphoreGiveRecursive(bus_lock);
+    return ok ? ESP_OK : ESP_FAIL;
 }
 
-bool touch_init(void)
+#if CONFIG_TOUCH_READ_BENCH
+/* Время одного отсчёта с points касаниями: старый путь (статус и по
+ * транзакции на точку) против чтения кадра одним куском. Запись нуля в
+ * статус безвредна — сбрасывает флаг готовности, как и при обычном чтении. */
+static void touch_read_bench(void)
 {
-    ESP_LOGI(TAG, "Initializing GT911 touchscreen...");
-    
-    /* Configure I2C */
-    i2c_config_t conf = {
-        .mode = I2C_MODE_MASTER,
-        .sda_io_num = TOUCH_GT911_SDA,
-        .scl_io_num = TOUCH_GT911_SCL,
-        .sda_pullup_en = GPIO_PULLUP_ENABLE,
-        .scl_pullup_en = GPIO_PULLUP_ENABLE,
-        .master.clk_speed = I2C_MASTER_FREQ_HZ,
-    };
-    
-    esp_err_t ret = i2c_param_config(I2C_MASTER_NUM, &conf);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "I2C config failed: %s", esp_err_to_name(ret));
+    uint8_t frame[GT911_FRAME_SIZE];
+    uint8_t zero = 0;
+
+    for (uint8_t points = 1; points <= GT911_MAX_POINTS; points += GT911_MAX_POINTS - 1) {
+        int64_t t0 = esp_timer_get_time();
+        for (int n = 0; n < TOUCH_BENCH_ITERATIONS; n++) {
+            (void)gt911_read_reg(GT911_REG_STATUS, frame, 1);
+            for (uint8_t i = 0; i < points; i++) {
+                (void)gt911_read_reg(GT911_REG_DATA + i * GT911_POINT_SIZE, frame + 1 + i * GT911_POINT_SIZE,
+                                     GT911_POINT_SIZE);
+            }
+            (void)gt911_write_reg(GT911_REG_STATUS, &zero, 1);
+        }
+        int64_t t1 = esp_timer_get_time();
+        for (int n = 0; n < TOUCH_BENCH_ITERATIONS; n++) {
+            (void)gt911_read_reg(GT911_REG_STATUS, frame, 1 + points * GT911_POINT_SIZE);
+            (void)gt911_write_reg(GT911_REG_STATUS, &zero, 1);
+        }
+        int64_t t2 = esp_timer_get_time();
+
+        ESP_LOGI(TAG, "Read bench, %u point(s): per-point %lld us/sample, burst %lld us/sample", points,
+                 (t1 - t0) / TOUCH_BENCH_ITERATIONS, (t2 - t1) / TOUCH_BENCH_ITERATIONS);
+    }
+}
+#endif
+
+static void config_shadow_save(void)
+{
+    struct {
+        uint8_t cfg[GT911_CONFIG_SIZE];
+        uint32_t hash;
+    } shadow;
+    memcpy(shadow.cfg, config_buf, sizeof(shadow.cfg));
+    shadow.hash = config_hash(shadow.cfg);
+
+    nvs_handle_t nvs;
+    if (nvs_open(TOUCH_NVS_NAMESPACE, NVS_READWRITE, &nvs) != ESP_OK) {
+        return;
+    }
+    if (nvs_set_blob(nvs, TOUCH_NVS_KEY_SHADOW, &shadow, sizeof(shadow)) == ESP_OK) {
+        (void)nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+}
+
+/* Тень из NVS годится, если цела и совпадает с контроллером по версии и сумме:
+ * два однобайтовых чтения вместо всего блока */
+static bool config_shadow_load(void)
+{
+    struct {
+        uint8_t cfg[GT911_CONFIG_SIZE];
+        uint32_t hash;
+    } shadow;
+    size_t len = sizeof(shadow);
+
+    nvs_handle_t nvs;
+    if (nvs_open(TOUCH_NVS_NAMESPACE, NVS_READONLY, &nvs) != ESP_OK) {
         return false;
     }
-    
-    ret = i2c_driver_install(I2C_MASTER_NUM, conf.mode, 0, 0, 0);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "I2C driver install failed: %s", esp_err_to_name(ret));
+    esp_err_t ret = nvs_get_blob(nvs, TOUCH_NVS_KEY_SHADOW, &shadow, &len);
+    nvs_close(nvs);
+    if (ret != ESP_OK || len != sizeof(shadow) || config_hash(shadow.cfg) != shadow.hash) {
         return false;
     }
 
-    /* Small delay for GT911 to stabilize */
-    vTaskDelay(pdMS_TO_TICKS(100));
+    uint8_t version = 0;
+    uint8_t checksum = 0;
+    if (gt911_read_reg(GT911_REG_CONFIG, &version, 1) != ESP_OK
+        || gt911_read_reg(GT911_REG_CONFIG_CHKSUM, &checksum, 1) != ESP_OK
+        || version != shadow.cfg[GT911_CFG_VERSION] || checksum != shadow.cfg[GT911_CFG_CHKSUM]) {
+        return false;
+    }
 
-    /* Try to read product ID */
-    uint8_t product_id[4] = {0};
-    ret = gt911_read_reg(GT911_REG_PRODUCT_ID, product_id, 4);
-    
-    if (ret != ESP_OK) {
-        /* Try alternative address */
-        ESP_LOGW(TAG, "Trying alternative I2C address...");
-        gt911_addr = GT911_I2C_ADDR_BA;
-        vTaskDelay(pdMS_TO_TICKS(50));
-        ret = gt911_read_reg(GT911_REG_PRODUCT_ID, product_id, 4);
+    memcpy(config_buf, shadow.cfg, sizeof(config_buf));
+    return true;
+}
+
+bool touch_init(void)
+{
+    ESP_LOGI(TAG, "Initializing GT911 touchscreen...");
+
+#if CONFIG_IDF_TARGET_LINUX
+    /* Сборка под Linux: модель GT911 проигрывает трассу из файла T1_TOUCH_TRACE */
+    gt911_bus_t *gt911_bus = gt911_bus_sim_open(getenv("T1_TOUCH_TRACE"));
+#else
+    gt911_bus_t *gt911_bus = gt911_bus_i2c_create(TOUCH_GT911_SDA, TOUCH_GT911_SCL, I2C_MASTER_FREQ_HZ);
+#endif
+    if (gt911_bus == NULL) {
+        return false;
     }
-    
+    return touch_init_bus(gt911_bus);
+}
+
+bool touch_init_bus(gt911_bus_t *gt911_bus)
+{
+    if (bus_lock == NULL) {
+        bus_lock = xSemaphoreCreateRecursiveMutex();
+        if (bus_lock == NULL) {
+            ESP_LOGE(TAG, "No memory for bus mutex");
+            return false;
+        }
+    }
+    bus = gt911_bus;
+
+    uint8_t product_id[4] = {0};
+    esp_err_t ret = gt911_read_reg(GT911_REG_PRODUCT_ID, product_id, 4);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "✗ GT911 not found on I2C bus");
+        ESP_LOGE(TAG, "✗ Failed to read GT911 product ID");
         return false;
     }
 
-    ESP_LOGI(TAG, "✓ GT911 detected at I2C addr 0x%02X", gt911_addr);
     ESP_LOGI(TAG, "✓ Product ID: %c%c%c%c", 
              product_id[0], product_id[1], product_id[2], product_id[3]);
 
-    /* Считать текущий конфиг, чтобы можно было менять разрешение */
-    ret = gt911_read_reg(GT911_REG_CONFIG, config_buf, GT911_CONFIG_SIZE);
-    if (ret != ESP_OK) {
-        ESP_LOGW(TAG, "Failed to read config, continue without set_resolution (err=%s)", esp_err_to_name(ret));
+    /* Текущий конфиг нужен, чтобы менять разрешение и настройки */
+    if (config_shadow_load()) {
+        config_valid = true;
+        ESP_LOGI(TAG, "Config from NVS shadow (version 0x%02X)", config_buf[GT911_CFG_VERSION]);
+    } else if (gt911_read_reg(GT911_REG_CONFIG, config_buf, GT911_CONFIG_SIZE) == ESP_OK) {
+        config_valid = true;
+        config_shadow_save();
+    } else {
+        ESP_LOGW(TAG, "Failed to read config, continue without set_resolution");
     }
 
+#if CONFIG_TOUCH_READ_BENCH
+    touch_read_bench();
+#endif
+
+    calib_load();
+    xform_update();
+
     initialized = true;
     return true;
 }
@@ -196,6 +360,38 @@ bool touch_has_signal(void)
 void touch_set_rotation(uint8_t rot)
 {
     rotation = rot;
+    xform_update();
+}
+
+void touch_set_raw_mode(bool raw)
+{
+    raw_mode = raw;
+    xform_update();
+}
+
+bool touch_set_calibration(const touch_affine_t *m)
+{
+    nvs_handle_t nvs;
+    esp_err_t ret = nvs_open(TOUCH_NVS_NAMESPACE, NVS_READWRITE, &nvs);
+    if (ret == ESP_OK) {
+        ret = m ? nvs_set_blob(nvs, TOUCH_NVS_KEY_CALIB, m, sizeof(*m)) : nvs_erase_key(nvs, TOUCH_NVS_KEY_CALIB);
+        if (ret == ESP_ERR_NVS_NOT_FOUND) ret = ESP_OK; /* стирать было нечего */
+        if (ret == ESP_OK) ret = nvs_commit(nvs);
+        nvs_close(nvs);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to store calibration: %s", esp_err_to_name(ret));
+    }
+
+    calibrated = m != NULL;
+    if (m) calib = *m;
+    xform_update();
+    return ret == ESP_OK;
+}
+
+bool touch_is_calibrated(void)
+{
+    return calibrated;
 }
 
 bool touch_set_resolution(uint16_t width, uint16_t height)
@@ -204,78 +400,180 @@ bool touch_set_resolution(uint16_t width, uint16_t height)
 
     panel_w = width;
     panel_h = height;
-
-    if (gt911_read_reg(GT911_REG_CONFIG, config_buf, GT911_CONFIG_SIZE) != ESP_OK) {
-        ESP_LOGW(TAG, "read config failed");
-        return false;
+    xform_update();
+
+    /* Чтение и запись конфига одним куском: чужая запись между ними потерялась бы */
+    (void)xSemaphoreTakeRecursive(bus_lock, portMAX_DELAY);
+    touch_gt911_cfg_t cfg;
+    bool ok = touch_gt911_get_config(&cfg);
+    if (ok) {
+        cfg.x_max = width;
+        cfg.y_max = height;
+        ok = touch_gt911_set_config(&cfg);
     }
+    (void)xSemaphoreGiveRecursive(bus_lock);
+    return ok;
+}
 
-    /* Обновить X/Y max */
-    config_buf[GT911_REG_CONFIG + 0x01 - GT911_REG_CONFIG] = (uint8_t)(width & 0xFF);       /* X_OUTPUT_MAX_LOW  */
-    config_buf[GT911_REG_CONFIG + 0x02 - GT911_REG_CONFIG] = (uint8_t)((width >> 8) & 0xFF);/* X_OUTPUT_MAX_HIGH */
-    config_buf[GT911_REG_CONFIG + 0x03 - GT911_REG_CONFIG] = (uint8_t)(height & 0xFF);      /* Y_OUTPUT_MAX_LOW  */
-    config_buf[GT911_REG_CONFIG + 0x04 - GT911_REG_CONFIG] = (uint8_t)((height >> 8) & 0xFF);/* Y_OUTPUT_MAX_HIGH */
+bool touch_gt911_get_config(touch_gt911_cfg_t *cfg)
+{
+    if (!config_valid) return false;
+
+    (void)xSemaphoreTakeRecursive(bus_lock, portMAX_DELAY);
+    cfg->x_max = (uint16_t)(config_buf[GT911_CFG_X_MAX] | (config_buf[GT911_CFG_X_MAX + 1] << 8));
+    cfg->y_max = (uint16_t)(config_buf[GT911_CFG_Y_MAX] | (config_buf[GT911_CFG_Y_MAX + 1] << 8));
+    cfg->touch_level = config_buf[GT911_CFG_TOUCH_LEVEL];
+    cfg->leave_level = config_buf[GT911_CFG_LEAVE_LEVEL];
+    cfg->refresh_period = config_buf[GT911_CFG_REFRESH_RATE] & 0x0F;
+    cfg->filter = config_buf[GT911_CFG_FILTER] & 0x3F;
+    (void)xSemaphoreGiveRecursive(bus_lock);
+    return true;
+}
 
-    calc_checksum_and_mark_fresh();
+/* Под bus_lock: config_buf не меняется, пока сравниваем и пишем */
+static bool config_write(const touch_gt911_cfg_t *cfg)
+{
+    uint8_t want[GT911_CONFIG_SIZE];
+    memcpy(want, config_buf, sizeof(want));
+    want[GT911_CFG_X_MAX] = (uint8_t)(cfg->x_max & 0xFF);
+    want[GT911_CFG_X_MAX + 1] = (uint8_t)(cfg->x_max >> 8);
+    want[GT911_CFG_Y_MAX] = (uint8_t)(cfg->y_max & 0xFF);
+    want[GT911_CFG_Y_MAX + 1] = (uint8_t)(cfg->y_max >> 8);
+    want[GT911_CFG_TOUCH_LEVEL] = cfg->touch_level;
+    want[GT911_CFG_LEAVE_LEVEL] = cfg->leave_level;
+    want[GT911_CFG_REFRESH_RATE] = (uint8_t)((want[GT911_CFG_REFRESH_RATE] & 0xF0) | (cfg->refresh_period & 0x0F));
+    want[GT911_CFG_FILTER] = (uint8_t)((want[GT911_CFG_FILTER] & 0xC0) | (cfg->filter & 0x3F));
+    want[GT911_CFG_CHKSUM] = config_checksum(want);
+
+    /* Пишем только диапазон изменившихся байтов, затем сумму и флаг обновления */
+    int first = -1;
+    int last = -1;
+    for (int i = 0; i < GT911_CFG_CHKSUM; i++) {
+        if (want[i] != config_buf[i]) {
+            if (first < 0) first = i;
+            last = i;
+        }
+    }
+    if (first < 0) {
+        ESP_LOGI(TAG, "Config already up to date, no write");
+        return true;
+    }
 
-    if (gt911_write_reg(GT911_REG_CONFIG, config_buf, GT911_CONFIG_SIZE) != ESP_OK) {
+    if (gt911_write_reg(GT911_REG_CONFIG + first, want + first, (size_t)(last - first + 1)) != ESP_OK) {
         ESP_LOGW(TAG, "write config failed");
         return false;
     }
+    uint8_t tail[2] = { want[GT911_CFG_CHKSUM], 1 }; /* 0x80FF сумма, 0x8100 — применить */
+    if (gt911_write_reg(GT911_REG_CONFIG_CHKSUM, tail, sizeof(tail)) != ESP_OK) {
+        ESP_LOGW(TAG, "write config checksum failed");
+        return false;
+    }
+    ESP_LOGI(TAG, "Config updated: bytes 0x%04X..0x%04X", GT911_REG_CONFIG + first, GT911_REG_CONFIG + last);
 
-    /* Подтвердить обновление */
-    uint8_t fresh = 1;
-    (void)gt911_write_reg(GT911_REG_CONFIG_FRESH, &fresh, 1);
+    memcpy(config_buf, want, sizeof(config_buf));
+    config_shadow_save();
+    /* Контроллер применяет конфиг: задача тача подождёт на bus_lock */
     vTaskDelay(pdMS_TO_TICKS(10));
     return true;
 }
 
-bool touch_read_points(int16_t *xs, int16_t *ys, uint8_t *count)
+bool touch_gt911_set_config(const touch_gt911_cfg_t *cfg)
 {
-    if (!initialized) {
-        if (count) *count = 0;
+    if (!config_valid) {
+        ESP_LOGW(TAG, "Config not loaded, skip write");
         return false;
     }
 
-    uint8_t status = 0;
-    if (gt911_read_reg(GT911_REG_STATUS, &status, 1) != ESP_OK) {
-        if (count) *count = 0;
-        return false;
+    (void)xSemaphoreTakeRecursive(bus_lock, portMAX_DELAY);
+    bool ok = config_write(cfg);
+    (void)xSemaphoreGiveRecursive(bus_lock);
+    return ok;
+}
+
+/**
+ * @brief Прочитать кадр GT911 и сбросить флаг готовности
+ * @return число касаний (их точки в frame), -1 — нет новых данных или ошибка шины
+ */
+static int gt911_read_frame(uint8_t *frame)
+{
+    uint32_t t0 = evtrace_now();
+    /* Статус и точки одной транзакцией */
+    if (gt911_read_reg(GT911_REG_STATUS, frame, 1 + burst_points * GT911_POINT_SIZE) != ESP_OK) {
+        return -1;
     }
+    uint8_t status = frame[0];
 
     /* bit7 = buffer status, low nibble = points */
     if ((status & 0x80) == 0) {
-        if (count) *count = 0;
-        return false; /* нет новых данных */
+        return -1; /* нет новых данных */
     }
 
     uint8_t touches = status & 0x0F;
-    if (touches == 0 || touches > 5) {
-        uint8_t zero = 0;
-        gt911_write_reg(GT911_REG_STATUS, &zero, 1);
-        if (count) *count = 0;
-        return false;
+    if (touches > GT911_MAX_POINTS) {
+        touches = 0;
     }
 
-    /* Читаем по 8 байт на точку */
-    for (uint8_t i = 0; i < touches; i++) {
-        uint8_t buf[8] = {0};
-        if (gt911_read_reg(GT911_REG_DATA + i * 8, buf, 8) != ESP_OK) {
-            touches = i;
-            break;
+    /* Пальцев стало больше — дочитываем остальные точки и запоминаем на следующий кадр */
+    if (touches > burst_points) {
+        uint8_t first = burst_points;
+        if (gt911_read_reg(GT911_REG_DATA + first * GT911_POINT_SIZE, frame + 1 + first * GT911_POINT_SIZE,
+                           (touches - first) * GT911_POINT_SIZE) != ESP_OK) {
+            touches = first;
         }
-        uint16_t x = buf[1] | (buf[2] << 8);
-        uint16_t y = buf[3] | (buf[4] << 8);
-        apply_rotation(&x, &y);
-        if (xs) xs[i] = (int16_t)x;
-        if (ys) ys[i] = (int16_t)y;
+    }
+    if (touches > 0) {
+        burst_points = touches;
     }
 
     /* сбрасываем флаг готовности */
     uint8_t zero = 0;
     gt911_write_reg(GT911_REG_STATUS, &zero, 1);
 
-    if (count) *count = touches;
+    /* Пустые опросы в трассу не пишем */
+    evtrace_span(EVTRACE_TOUCH_READ, t0);
+    return touches;
+}
+
+/* Точки кадра: id, X, Y, размер (little-endian) в координатах GT911 */
+static void gt911_parse_frame(const uint8_t *frame, int touches, touch_trace_frame_t *raw)
+{
+    raw->count = (uint8_t)touches;
+    for (uint8_t i = 0; i < raw->count; i++) {
+        const uint8_t *buf = frame + 1 + i * GT911_POINT_SIZE;
+        touch_contact_t *contact = &raw->contacts[i];
+        contact->id = buf[0];
+        contact->x = (int16_t)(buf[1] | (buf[2] << 8));
+        contact->y = (int16_t)(buf[3] | (buf[4] << 8));
+        contact->size = (uint16_t)(buf[5] | (buf[6] << 8));
+    }
+}
+
+/* Сырая точка -> координаты экрана */
+static void point_to_screen(touch_contact_t *contact)
+{
+    portENTER_CRITICAL(&xform_lock);
+    touch_affine_t m = xform;
+    portEXIT_CRITICAL(&xform_lock);
+    touch_affine_apply(&m, &contact->x, &contact->y);
+}
+
+bool touch_read_points(int16_t *xs, int16_t *ys, uint8_t *count)
+{
+    uint8_t frame[GT911_FRAME_SIZE];
+    touch_trace_frame_t raw;
+    int touches = initialized ? gt911_read_frame(frame) : -1;
+    if (touches < 0) {
+        touches = 0;
+    }
+    gt911_parse_frame(frame, touches, &raw);
+
+    for (uint8_t i = 0; i < touches; i++) {
+        point_to_screen(&raw.contacts[i]);
+        if (xs) xs[i] = raw.contacts[i].x;
+        if (ys) ys[i] = raw.contacts[i].y;
+    }
+
+    if (count) *count = (uint8_t)touches;
     return touches > 0;
 }
 
@@ -297,4 +595,247 @@ bool touch_released(void)
 {
     /* GT911 в простой реализации всегда возвращает true когда нет касания */
     return initialized;
-}
\ No newline at end of file
+}
+
+static bool ring_push(const touch_sample_t *sample)
+{
+    uint32_t head = atomic_load_explicit(&ring_head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&ring_tail, memory_order_acquire);
+    if (head - tail >= TOUCH_RING_SIZE) {
+        return false;
+    }
+    ring[head & (TOUCH_RING_SIZE - 1)] = *sample;
+    atomic_store_explicit(&ring_head, head + 1, memory_order_release);
+    ring_pushed++;
+    return true;
+}
+
+bool touch_ring_pop(touch_sample_t *sample)
+{
+    uint32_t tail = atomic_load_explicit(&ring_tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&ring_head, memory_order_acquire);
+    if (tail == head) {
+        return false;
+    }
+    *sample = ring[tail & (TOUCH_RING_SIZE - 1)];
+    atomic_store_explicit(&ring_tail, tail + 1, memory_order_release);
+    return true;
+}
+
+uint32_t touch_ring_count(void)
+{
+    return atomic_load_explicit(&ring_head, memory_order_acquire)
+         - atomic_load_explicit(&ring_tail, memory_order_acquire);
+}
+
+void touch_get_ring_stats(uint32_t *pushed, uint32_t *overruns)
+{
+    if (pushed) *pushed = ring_pushed;
+    if (overruns) *overruns = ring_overruns;
+}
+
+static void touch_task(void *arg)
+{
+    (void)arg;
+    const TickType_t period = pdMS_TO_TICKS(CONFIG_TOUCH_POLL_PERIOD_MS);
+    uint8_t frame[GT911_FRAME_SIZE];
+    touch_trace_frame_t raw;
+    touch_sample_t last = {0};
+    touch_sample_t pending;
+    bool has_pending = false;
+    uint32_t overruns_logged = 0;
+    int64_t overrun_log_us = 0;
+#if CONFIG_TOUCH_FILTER
+    touch_filter_t filter;
+    touch_filter_init(&filter, &(touch_filter_cfg_t){
+        .min_cutoff_mhz = CONFIG_TOUCH_FILTER_MIN_CUTOFF_MHZ,
+        .beta_mhz = CONFIG_TOUCH_FILTER_BETA_MHZ,
+        .d_cutoff_mhz = TOUCH_FILTER_D_CUTOFF_MHZ,
+        .predict_us = CONFIG_TOUCH_PREDICT_MS * 1000,
+    });
+#endif
+
+    while (1) {
+        int touches = -1;
+        const bool from_replay = replay;
+        if (from_replay) {
+            /* Следующий кадр трассы берём, только когда прошлый ушёл в кольцо:
+             * при воспроизведении без пауз отсчёты не теряются */
+            if (has_pending) {
+                vTaskDelay(1);
+            } else if (xQueueReceive(inject_queue, &raw, period) == pdTRUE) {
+                touches = raw.count;
+            }
+        } else {
+            if (irq_mode) {
+                /* Пока отсчёт ждёт места в кольце, просыпаемся и без INT */
+                (void)ulTaskNotifyTake(pdTRUE, has_pending ? period : portMAX_DELAY);
+            } else {
+                vTaskDelay(period);
+            }
+            touches = gt911_read_frame(frame);
+            if (touches >= 0) {
+                raw.t_us = esp_timer_get_time();
+                gt911_parse_frame(frame, touches, &raw);
+                void (*hook)(const touch_trace_frame_t *f) = frame_hook;
+                if (hook) hook(&raw);
+            }
+        }
+
+        /* Сменился источник — начинаем с чистого листа, как после отпускания */
+        if (atomic_exchange(&source_changed, false)) {
+            memset(&last, 0, sizeof(last));
+            has_pending = false;
+        }
+
+        if (touches >= 0) {
+            last.timestamp_us = raw.t_us;
+            last.replayed = from_replay;
+            last.count = raw.count;
+            for (uint8_t i = 0; i < last.count; i++) {
+                last.contacts[i] = raw.contacts[i];
+                point_to_screen(&last.contacts[i]);
+            }
+            if (touches > 0) {
+                uint8_t prev_id = last.id;
+                last.id = last.contacts[0].id;
+                last.x = last.contacts[0].x;
+                last.y = last.contacts[0].y;
+                last.size = last.contacts[0].size;
+#if CONFIG_TOUCH_FILTER
+                if (raw_mode) {
+                    /* Калибровка решает МНК по точкам GT911 как есть: без
+                     * сглаживания, упреждения и обрезки по краю панели */
+                    touch_filter_reset(&filter);
+                } else {
+                    /* Новое касание или другой палец — история фильтра не годится */
+                    if (!last.pressed || last.id != prev_id) {
+                        touch_filter_reset(&filter);
+                    }
+                    touch_filter_apply(&filter, last.timestamp_us, &last.x, &last.y);
+                    /* Упреждение может вынести точку за край экрана */
+                    last.x = last.x < 0 ? 0 : last.x >= (int16_t)panel_w ? (int16_t)(panel_w - 1) : last.x;
+                    last.y = last.y < 0 ? 0 : last.y >= (int16_t)panel_h ? (int16_t)(panel_h - 1) : last.y;
+                }
+#else
+                (void)prev_id;
+#endif
+            }
+            /* Отпускание приходит кадром без точек: остаются координаты последнего касания */
+            last.pressed = touches > 0;
+            if (has_pending) {
+                ring_overruns++; /* кольцо всё ещё полно: старый отсчёт заменяем новым */
+            }
+            pending = last;
+            has_pending = true;
+        }
+
+        if (has_pending && ring_push(&pending)) {
+            has_pending = false;
+            if (sample_cb) sample_cb(sample_cb_arg);
+        }
+
+        if (ring_overruns != overruns_logged && esp_timer_get_time() - overrun_log_us > 1000000) {
+            ESP_LOGW(TAG, "Sample ring overrun: %lu dropped", (unsigned long)(ring_overruns - overruns_logged));
+            overruns_logged = ring_overruns;
+            overrun_log_us = esp_timer_get_time();
+        }
+    }
+}
+
+#if TOUCH_GT911_INT >= 0
+static void IRAM_ATTR gt911_int_isr(void *arg)
+{
+    (void)arg;
+    BaseType_t hp_task_woken = pdFALSE;
+    vTaskNotifyGiveFromISR(sample_task, &hp_task_woken);
+    portYIELD_FROM_ISR(hp_task_woken);
+}
+
+static esp_err_t gt911_int_enable(void)
+{
+    /* Уровневые режимы INT ловим по фронту начала импульса */
+    static const gpio_int_type_t trigger_to_intr[] = {
+        GPIO_INTR_POSEDGE, GPIO_INTR_NEGEDGE, GPIO_INTR_NEGEDGE, GPIO_INTR_POSEDGE,
+    };
+    uint8_t trigger = config_buf[GT911_REG_MODULE_SW1 - GT911_REG_CONFIG] & 0x03;
+
+    gpio_config_t io = {
+        .pin_bit_mask = 1ULL << TOUCH_GT911_INT,
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = 0,
+        .pull_down_en = 0,
+        .intr_type = trigger_to_intr[trigger],
+    };
+    esp_err_t ret = gpio_config(&io);
+    if (ret == ESP_OK) {
+        ret = gpio_install_isr_service(0);
+        if (ret == ESP_ERR_INVALID_STATE) ret = ESP_OK; /* уже установлен кем-то ещё */
+    }
+    if (ret == ESP_OK) {
+        ret = gpio_isr_handler_add(TOUCH_GT911_INT, gt911_int_isr, NULL);
+    }
+    return ret;
+}
+#endif
+
+bool touch_task_start(void (*cb)(void *arg), void *arg)
+{
+    if (!initialized || sample_task) return false;
+
+    sample_cb = cb;
+    sample_cb_arg = arg;
+    inject_queue = xQueueCreate(1, sizeof(touch_trace_frame_t));
+    if (inject_queue == NULL) {
+        return false;
+    }
+    if (xTaskCreatePinnedToCore(touch_task, "touch", TOUCH_TASK_STACK, NULL, TOUCH_TASK_PRIO,
+                                &sample_task, tskNO_AFFINITY) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create touch task");
+        sample_task = NULL;
+        return false;
+    }
+
+#if TOUCH_GT911_INT >= 0
+    /* Прерывание — только после создания задачи: ISR будит её по дескриптору */
+    esp_err_t ret = gt911_int_enable();
+    if (ret == ESP_OK) {
+        irq_mode = true;
+    } else {
+        ESP_LOGW(TAG, "INT on GPIO%d unavailable (%s), falling back to polling", TOUCH_GT911_INT, esp_err_to_name(ret));
+    }
+#endif
+
+    ESP_LOGI(TAG, "Sampling task started: %s", irq_mode ? "INT" : "polling");
+    return true;
+}
+
+void touch_set_frame_hook(void (*hook)(const touch_trace_frame_t *f))
+{
+    frame_hook = hook;
+}
+
+void touch_set_replay(bool on)
+{
+    if (on == replay) return;
+    if (!on && inject_queue) {
+        xQueueReset(inject_queue);
+    }
+    replay = on;
+    atomic_store(&source_changed, true);
+    /* В режиме INT задача тача может спать в ulTaskNotifyTake() без таймаута */
+    if (sample_task) {
+        xTaskNotifyGive(sample_task);
+    }
+}
+
+bool touch_inject_frame(const touch_trace_frame_t *f, uint32_t timeout_ms)
+{
+    if (!replay || inject_queue == NULL) return false;
+    if (xQueueSend(inject_queue, f, pdMS_TO_TICKS(timeout_ms)) != pdTRUE) return false;
+    /* Задача тача могла уснуть на INT до того, как увидела replay */
+    if (sample_task) {
+        xTaskNotifyGive(sample_task);
+    }
+    return true;
+}
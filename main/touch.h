@@ -10,23 +10,58 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include "sdkconfig.h"
+#include "gt911_bus.h"
+#include "touch_affine.h"
+#include "touch_gesture.h"
+#include "touch_trace.h"
 
 /* GT911 Configuration - пины из Arduino-примера */
 #define TOUCH_GT911_SDA     19
 #define TOUCH_GT911_SCL     45
-#define TOUCH_GT911_INT     -1  /* Не используем IRQ */
+#define TOUCH_GT911_INT     CONFIG_TOUCH_GT911_INT_GPIO  /* -1: IRQ не подключен, опрос */
 #define TOUCH_GT911_RST     -1  /* Не используем аппаратный сброс */
 
 /* Координатное пространство (разрешение панели) */
 #define TOUCH_MAX_X         480
 #define TOUCH_MAX_Y         480
 
+/* Сколько касаний отслеживает GT911 */
+#define TOUCH_MAX_POINTS    5
+
+/* Глубина кольца отсчётов задачи тача, степень двойки */
+#define TOUCH_RING_SIZE     32
+
 /* Повороты, совместимые с Arduino Touch_GT911 */
 #define TOUCH_ROT_LEFT      0
 #define TOUCH_ROT_INVERTED  1
 #define TOUCH_ROT_RIGHT     2
 #define TOUCH_ROT_NORMAL    3
 
+/* Настройки GT911, которые имеет смысл менять из прошивки */
+typedef struct {
+    uint16_t x_max;             /* разрешение, в котором контроллер отдаёт координаты */
+    uint16_t y_max;
+    uint8_t touch_level;        /* порог касания */
+    uint8_t leave_level;        /* порог отпускания, меньше touch_level */
+    uint8_t refresh_period;     /* период отчёта 5 + N мс, 0..15 */
+    uint8_t filter;             /* собственное сглаживание контроллера, 0..63 */
+} touch_gt911_cfg_t;
+
+/* Кадр из задачи тача: основное (первое) касание для указателя LVGL
+ * и все контакты кадра для жестов */
+typedef struct {
+    int64_t timestamp_us;   /* esp_timer_get_time() сразу после чтения кадра */
+    int16_t x;              /* основное касание, после фильтра */
+    int16_t y;
+    uint16_t size;          /* площадь касания по GT911 */
+    uint8_t id;             /* track id GT911 */
+    bool pressed;           /* false — палец отпущен, x/y последнего касания */
+    bool replayed;          /* кадр из трассы (touch_inject_frame), а не с GT911 */
+    uint8_t count;          /* контактов в кадре, 0 — все отпущены */
+    touch_contact_t contacts[TOUCH_MAX_POINTS]; /* как прислал GT911, без фильтра */
+} touch_sample_t;
+
 /* Touch coordinates (updated by driver) */
 extern int16_t touch_last_x;
 extern int16_t touch_last_y;
@@ -37,6 +72,14 @@ extern int16_t touch_last_y;
  */
 bool touch_init(void);
 
+/**
+ * @brief Инициализировать поверх готовой шины (мок GT911 на хосте)
+ *
+ * touch_init() поднимает I2C через gt911_bus_i2c_create(), а в сборке под Linux —
+ * модель gt911_bus_sim_open() с трассой из T1_TOUCH_TRACE, и вызывает эту же функцию.
+ */
+bool touch_init_bus(gt911_bus_t *bus);
+
 /**
  * @brief Check if touch data is available
  * @return true if touch data ready
@@ -57,14 +100,46 @@ bool touch_released(void);
 
 /**
  * @brief Установить ориентацию экрана (как в Arduino Touch_GT911)
+ *
+ * Действует, пока нет калибровки: матрица калибровки уже включает поворот.
  */
 void touch_set_rotation(uint8_t rot);
 
+/**
+ * @brief Отдавать координаты GT911 без преобразования (на время калибровки)
+ *
+ * Ни матрицы, ни фильтра с упреждением, ни обрезки по краю панели.
+ */
+void touch_set_raw_mode(bool raw);
+
+/**
+ * @brief Применить матрицу калибровки и сохранить её в NVS
+ * @param m NULL — забыть калибровку и вернуться к повороту
+ * @return false, если не удалось сохранить (матрица всё равно применена)
+ */
+bool touch_set_calibration(const touch_affine_t *m);
+
+bool touch_is_calibrated(void);
+
 /**
  * @brief Обновить разрешение панели в контроллере (запись в конфиг GT911)
  */
 bool touch_set_resolution(uint16_t width, uint16_t height);
 
+/**
+ * @brief Текущие настройки GT911 из тени конфига, без обращения к шине
+ */
+bool touch_gt911_get_config(touch_gt911_cfg_t *cfg);
+
+/**
+ * @brief Записать настройки GT911
+ *
+ * В контроллер уходят только изменившиеся байты, контрольная сумма и флаг
+ * обновления; если ничего не изменилось, запись пропускается. Тень конфига
+ * сохраняется в NVS, и следующая загрузка не читает конфиг целиком.
+ */
+bool touch_gt911_set_config(const touch_gt911_cfg_t *cfg);
+
 /**
  * @brief Прочитать до 5 точек
  * @param xs массив из 5 значений X
@@ -74,3 +149,56 @@ bool touch_set_resolution(uint16_t width, uint16_t height);
  */
 bool touch_read_points(int16_t *xs, int16_t *ys, uint8_t *count);
 
+/**
+ * @brief Запустить задачу опроса тача
+ *
+ * Задача читает GT911 по INT (если подключен) или раз в
+ * CONFIG_TOUCH_POLL_PERIOD_MS и кладёт отсчёты в кольцо; после каждого
+ * нового отсчёта вызывает cb(arg) в своём контексте. После старта шиной
+ * владеет задача: touch_read_points() и touch_touched() не вызывать.
+ * touch_set_resolution() и touch_gt911_get/set_config() можно звать из любой
+ * задачи: обращения к GT911 и тень конфига идут под общим мьютексом, кадр
+ * задачи тача ждёт окончания записи конфига.
+ */
+bool touch_task_start(void (*cb)(void *arg), void *arg);
+
+/**
+ * @brief Забрать самый старый отсчёт из кольца (один потребитель)
+ * @return false, если кольцо пусто
+ */
+bool touch_ring_pop(touch_sample_t *sample);
+
+/**
+ * @brief Сколько отсчётов ждёт в кольце
+ */
+uint32_t touch_ring_count(void);
+
+/**
+ * @brief Счётчики кольца: сколько отсчётов положено и сколько потеряно из-за переполнения
+ */
+void touch_get_ring_stats(uint32_t *pushed, uint32_t *overruns);
+
+/**
+ * @brief Отдавать каждый сырой кадр GT911 в hook (запись трассы)
+ *
+ * hook вызывается из задачи тача сразу после чтения, до калибровки и
+ * фильтра; NULL — выключить. Во время воспроизведения не вызывается.
+ */
+void touch_set_frame_hook(void (*hook)(const touch_trace_frame_t *f));
+
+/**
+ * @brief Брать кадры из touch_inject_frame() вместо GT911
+ *
+ * Дальше кадры идут тем же путём: матрица, фильтр, кольцо, sample_cb.
+ * При переключении состояние задачи сбрасывается, как после отпускания.
+ */
+void touch_set_replay(bool on);
+
+/**
+ * @brief Передать задаче тача кадр трассы (t_us — метка отсчёта)
+ *
+ * Задача берёт следующий кадр, только когда прошлый лёг в кольцо, поэтому
+ * при вызове подряд без пауз отсчёты не теряются.
+ * @return false — воспроизведение не включено или таймаут
+ */
+bool touch_inject_frame(const touch_trace_frame_t *f, uint32_t timeout_ms);
@@ -0,0 +1,101 @@
+/**
+ * @file touch_affine.c
+ * @brief Подбор матрицы калибровки по точкам
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include "touch_affine.h"
+
+/* Больше — это не калибровка, а ошибка касаний; заодно держит a*x в int32 */
+#define AFFINE_MAX_SCALE    4.0
+#define AFFINE_MAX_OFFSET   2048.0
+
+void touch_affine_identity(touch_affine_t *m)
+{
+    *m = (touch_affine_t){ .a = TOUCH_AFFINE_ONE, .e = TOUCH_AFFINE_ONE };
+}
+
+static double det3(const double m[3][3])
+{
+    return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1])
+         - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0])
+         + m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+}
+
+/* Нормальные уравнения M * [p q r] = v решаем по Крамеру: разовый расчёт, double допустим */
+static bool solve3(const double m[3][3], const double v[3], double det, double out[3])
+{
+    for (int col = 0; col < 3; col++) {
+        double t[3][3];
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++) {
+                t[i][j] = (j == col) ? v[i] : m[i][j];
+            }
+        }
+        out[col] = det3(t) / det;
+    }
+    return fabs(out[0]) < AFFINE_MAX_SCALE && fabs(out[1]) < AFFINE_MAX_SCALE && fabs(out[2]) < AFFINE_MAX_OFFSET;
+}
+
+bool touch_affine_solve(touch_affine_t *m, const touch_affine_point_t *raw, const touch_affine_point_t *screen,
+                        size_t n, int32_t *max_err_px)
+{
+    if (n < 3) {
+        return false;
+    }
+
+    double sxx = 0, sxy = 0, syy = 0, sx = 0, sy = 0;
+    double vx[3] = {0};
+    double vy[3] = {0};
+    for (size_t i = 0; i < n; i++) {
+        double x = raw[i].x;
+        double y = raw[i].y;
+        sxx += x * x;
+        sxy += x * y;
+        syy += y * y;
+        sx += x;
+        sy += y;
+        vx[0] += x * screen[i].x;
+        vx[1] += y * screen[i].x;
+        vx[2] += screen[i].x;
+        vy[0] += x * screen[i].y;
+        vy[1] += y * screen[i].y;
+        vy[2] += screen[i].y;
+    }
+    const double mat[3][3] = {
+        { sxx, sxy, sx },
+        { sxy, syy, sy },
+        { sx, sy, (double)n },
+    };
+    double det = det3(mat);
+    /* Точки на одной прямой или слишком близко */
+    if (fabs(det) < 1.0) {
+        return false;
+    }
+
+    double px[3];
+    double py[3];
+    if (!solve3(mat, vx, det, px) || !solve3(mat, vy, det, py)) {
+        return false;
+    }
+    m->a = (int32_t)lround(px[0] * TOUCH_AFFINE_ONE);
+    m->b = (int32_t)lround(px[1] * TOUCH_AFFINE_ONE);
+    m->c = (int32_t)lround(px[2] * TOUCH_AFFINE_ONE);
+    m->d = (int32_t)lround(py[0] * TOUCH_AFFINE_ONE);
+    m->e = (int32_t)lround(py[1] * TOUCH_AFFINE_ONE);
+    m->f = (int32_t)lround(py[2] * TOUCH_AFFINE_ONE);
+
+    if (max_err_px) {
+        int32_t worst = 0;
+        for (size_t i = 0; i < n; i++) {
+            int16_t x = raw[i].x;
+            int16_t y = raw[i].y;
+            touch_affine_apply(m, &x, &y);
+            int32_t err = abs(x - screen[i].x) + abs(y - screen[i].y);
+            if (err > worst) worst = err;
+        }
+        *max_err_px = worst;
+    }
+    return true;
+}
@@ -0,0 +1,48 @@
+/**
+ * @file touch_affine.h
+ * @brief Преобразование координат тача матрицей 2x3 в фиксированной точке
+ *
+ * x' = (a*x + b*y + c) / 65536, y' = (d*x + e*y + f) / 65536 — поворот,
+ * отражение, масштаб и сдвиг одним шагом без ветвлений. Матрицу даёт либо
+ * поворот панели, либо калибровка по 3..5 касаниям мишеней (наименьшие
+ * квадраты).
+ *
+ * Модуль не зависит от ESP-IDF и LVGL и собирается на хосте.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define TOUCH_AFFINE_ONE    65536
+
+typedef struct {
+    int32_t a, b, c;
+    int32_t d, e, f;
+} touch_affine_t;
+
+typedef struct {
+    int16_t x;
+    int16_t y;
+} touch_affine_point_t;
+
+static inline void touch_affine_apply(const touch_affine_t *m, int16_t *x, int16_t *y)
+{
+    int32_t x0 = *x;
+    int32_t y0 = *y;
+    *x = (int16_t)((m->a * x0 + m->b * y0 + m->c + TOUCH_AFFINE_ONE / 2) >> 16);
+    *y = (int16_t)((m->d * x0 + m->e * y0 + m->f + TOUCH_AFFINE_ONE / 2) >> 16);
+}
+
+void touch_affine_identity(touch_affine_t *m);
+
+/**
+ * @brief Матрица по парам точек: сырые координаты GT911 -> экран
+ * @param n от 3 до 5, точки не на одной прямой
+ * @param max_err_px сюда — наибольшая невязка по точкам, пикселей (может быть NULL)
+ * @return false, если точки вырождены или коэффициенты вне разумных пределов
+ */
+bool touch_affine_solve(touch_affine_t *m, const touch_affine_point_t *raw, const touch_affine_point_t *screen,
+                        size_t n, int32_t *max_err_px);
@@ -0,0 +1,115 @@
+/**
+ * @file touch_calib.c
+ * @brief Калибровка по пяти мишеням: четыре угла с отступом и центр
+ */
+
+#include "touch_calib.h"
+#include "esp_log.h"
+#include "lvgl.h"
+#include "touch.h"
+#include "ui_palette.h"
+
+static const char *TAG = "CALIB";
+
+#define CALIB_POINTS        5
+#define CALIB_INSET_PX      48
+#define CALIB_TARGET_PX     32
+/* Невязка больше — касания были мимо мишеней, калибровку не принимаем */
+#define CALIB_MAX_ERR_PX    16
+
+static lv_obj_t *overlay = NULL;
+static lv_obj_t *target = NULL;
+static lv_obj_t *hint = NULL;
+static int step = 0;
+static int32_t sum_x = 0;
+static int32_t sum_y = 0;
+static int32_t sum_n = 0;
+static touch_affine_point_t raw[CALIB_POINTS];
+static touch_affine_point_t screen[CALIB_POINTS];
+
+static void show_target(void)
+{
+    lv_obj_set_pos(target, screen[step].x - CALIB_TARGET_PX / 2, screen[step].y - CALIB_TARGET_PX / 2);
+    lv_label_set_text_fmt(hint, "Tap the target  %d / %d", step + 1, CALIB_POINTS);
+}
+
+static void finish(void)
+{
+    touch_affine_t m;
+    int32_t err = 0;
+    touch_set_raw_mode(false);
+    if (touch_affine_solve(&m, raw, screen, CALIB_POINTS, &err) && err <= CALIB_MAX_ERR_PX) {
+        touch_set_calibration(&m);
+        ESP_LOGI(TAG, "Calibrated, max error %ld px", (long)err);
+    } else {
+        ESP_LOGW(TAG, "Calibration rejected (max error %ld px), keeping previous mapping", (long)err);
+    }
+    lv_obj_delete(overlay);
+    overlay = NULL;
+}
+
+/* Точку мишени усредняем по всему нажатию: одиночный отсчёт GT911 дрожит */
+static void overlay_event_cb(lv_event_t *e)
+{
+    lv_event_code_t code = lv_event_get_code(e);
+    if (code == LV_EVENT_PRESSING) {
+        lv_point_t p;
+        lv_indev_get_point(lv_indev_active(), &p);
+        sum_x += p.x;
+        sum_y += p.y;
+        sum_n++;
+    } else if (code == LV_EVENT_RELEASED && sum_n > 0) {
+        raw[step].x = (int16_t)(sum_x / sum_n);
+        raw[step].y = (int16_t)(sum_y / sum_n);
+        sum_x = sum_y = sum_n = 0;
+        if (++step == CALIB_POINTS) {
+            finish();
+        } else {
+            show_target();
+        }
+    }
+}
+
+void touch_calib_start(void)
+{
+    if (overlay) return;
+
+    int32_t w = lv_display_get_horizontal_resolution(NULL);
+    int32_t h = lv_display_get_vertical_resolution(NULL);
+    const touch_affine_point_t points[CALIB_POINTS] = {
+        { CALIB_INSET_PX, CALIB_INSET_PX },
+        { (int16_t)(w - CALIB_INSET_PX), CALIB_INSET_PX },
+        { (int16_t)(w - CALIB_INSET_PX), (int16_t)(h - CALIB_INSET_PX) },
+        { CALIB_INSET_PX, (int16_t)(h - CALIB_INSET_PX) },
+        { (int16_t)(w / 2), (int16_t)(h / 2) },
+    };
+    for (int i = 0; i < CALIB_POINTS; i++) {
+        screen[i] = points[i];
+    }
+    step = 0;
+    sum_x = sum_y = sum_n = 0;
+
+    overlay = lv_obj_create(lv_layer_top());
+    lv_obj_remove_style_all(overlay);
+    lv_obj_set_size(overlay, w, h);
+    lv_obj_set_style_bg_color(overlay, lv_color_hex(UI_COLOR_BG), LV_PART_MAIN);
+    lv_obj_set_style_bg_opa(overlay, LV_OPA_COVER, LV_PART_MAIN);
+    lv_obj_add_flag(overlay, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_add_event_cb(overlay, overlay_event_cb, LV_EVENT_ALL, NULL);
+
+    target = lv_obj_create(overlay);
+    lv_obj_remove_style_all(target);
+    lv_obj_set_size(target, CALIB_TARGET_PX, CALIB_TARGET_PX);
+    lv_obj_set_style_radius(target, LV_RADIUS_CIRCLE, LV_PART_MAIN);
+    lv_obj_set_style_border_width(target, 3, LV_PART_MAIN);
+    lv_obj_set_style_border_color(target, lv_color_hex(UI_COLOR_TRACK), LV_PART_MAIN);
+    lv_obj_remove_flag(target, LV_OBJ_FLAG_CLICKABLE);
+
+    hint = lv_label_create(overlay);
+    lv_obj_set_style_text_color(hint, lv_color_hex(UI_COLOR_TEXT), LV_PART_MAIN);
+    lv_obj_set_style_text_font(hint, &lv_font_montserrat_20, LV_PART_MAIN);
+    lv_obj_align(hint, LV_ALIGN_CENTER, 0, 48);
+
+    touch_set_raw_mode(true);
+    show_target();
+}
@@ -0,0 +1,15 @@
+/**
+ * @file touch_calib.h
+ * @brief Экран калибровки тача: пять мишеней, матрица в NVS
+ */
+
+#pragma once
+
+/**
+ * @brief Показать мишени поверх UI и откалибровать тач
+ *
+ * Вызывать в контексте LVGL (под display_lock). Пока идёт калибровка, тач
+ * отдаёт сырые координаты GT911; по пятому касанию матрица считается,
+ * применяется и сохраняется, экран калибровки закрывается сам.
+ */
+void touch_calib_start(void);
@@ -0,0 +1,74 @@
+/**
+ * @file touch_filter.c
+ * @brief One-Euro в фиксированной точке и линейное упреждение
+ */
+
+#include <stdlib.h>
+#include "touch_filter.h"
+
+/* 10^6 / (2 * pi) * 1000: tau[мкс] = TAU_SCALE / fc[мГц] */
+#define TAU_SCALE           159154943u
+
+/* Отсчёты чаще — шум таймстемпа, реже — палец стоял, историю не тянем */
+#define DT_MIN_US           1000
+#define DT_MAX_US           100000
+
+/* Вес нового значения для фильтра первого порядка, 1.0 = 65536 */
+static uint32_t alpha_q16(uint32_t cutoff_mhz, uint32_t dt_us)
+{
+    if (cutoff_mhz == 0) {
+        cutoff_mhz = 1;
+    }
+    uint32_t tau_us = TAU_SCALE / cutoff_mhz;
+    return (uint32_t)(((uint64_t)dt_us << 16) / (dt_us + tau_us));
+}
+
+static int32_t lowpass(int32_t prev, int32_t in, uint32_t alpha)
+{
+    return prev + (int32_t)(((int64_t)(in - prev) * alpha) >> 16);
+}
+
+static int16_t filter_axis(touch_filter_axis_t *a, const touch_filter_cfg_t *cfg, int16_t raw, uint32_t dt_us)
+{
+    int32_t raw_q8 = (int32_t)raw * 256;
+
+    /* Скорость — по сырой точке относительно прошлой оценки, как в One-Euro */
+    int32_t vel_q8 = (int32_t)(((int64_t)(raw_q8 - a->pos_q8) * 1000000) / dt_us);
+    a->vel_q8 = lowpass(a->vel_q8, vel_q8, alpha_q16(cfg->d_cutoff_mhz, dt_us));
+
+    uint32_t speed = (uint32_t)abs(a->vel_q8) >> 8;
+    uint32_t cutoff = cfg->min_cutoff_mhz + cfg->beta_mhz * speed;
+    a->pos_q8 = lowpass(a->pos_q8, raw_q8, alpha_q16(cutoff, dt_us));
+
+    int32_t out_q8 = a->pos_q8 + (int32_t)(((int64_t)a->vel_q8 * cfg->predict_us) / 1000000);
+    return (int16_t)((out_q8 + 128) >> 8);
+}
+
+void touch_filter_init(touch_filter_t *f, const touch_filter_cfg_t *cfg)
+{
+    f->cfg = *cfg;
+    touch_filter_reset(f);
+}
+
+void touch_filter_reset(touch_filter_t *f)
+{
+    f->primed = false;
+}
+
+void touch_filter_apply(touch_filter_t *f, int64_t t_us, int16_t *x, int16_t *y)
+{
+    int64_t dt = t_us - f->last_us;
+    if (!f->primed || dt > DT_MAX_US) {
+        f->x = (touch_filter_axis_t){ .pos_q8 = (int32_t)*x * 256, .vel_q8 = 0 };
+        f->y = (touch_filter_axis_t){ .pos_q8 = (int32_t)*y * 256, .vel_q8 = 0 };
+        f->last_us = t_us;
+        f->primed = true;
+        return;
+    }
+    if (dt < DT_MIN_US) {
+        dt = DT_MIN_US;
+    }
+    f->last_us = t_us;
+    *x = filter_axis(&f->x, &f->cfg, *x, (uint32_t)dt);
+    *y = filter_axis(&f->y, &f->cfg, *y, (uint32_t)dt);
+}
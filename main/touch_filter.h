@@ -0,0 +1,48 @@
+/**
+ * @file touch_filter.h
+ * @brief Сглаживание координат касания (One-Euro) и упреждение жеста
+ *
+ * Фильтр One-Euro в целых числах: частота среза растёт со скоростью пальца,
+ * поэтому неподвижный палец не дрожит, а быстрый жест не отстаёт.
+ * Скорость из того же фильтра экстраполирует точку на predict_us вперёд —
+ * на задержку от чтения GT911 до пикселей на экране.
+ *
+ * Координаты внутри хранятся в 1/256 пикселя. Модуль не зависит от ESP-IDF
+ * и собирается на хосте.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+    uint32_t min_cutoff_mhz;    /* частота среза неподвижного пальца, мГц */
+    uint32_t beta_mhz;          /* прибавка к частоте среза на 1 px/s скорости, мГц */
+    uint32_t d_cutoff_mhz;      /* частота среза оценки скорости, мГц */
+    uint32_t predict_us;        /* горизонт упреждения, 0 — без упреждения */
+} touch_filter_cfg_t;
+
+typedef struct {
+    int32_t pos_q8;             /* сглаженная координата, px * 256 */
+    int32_t vel_q8;             /* сглаженная скорость, px/s * 256 */
+} touch_filter_axis_t;
+
+typedef struct {
+    touch_filter_cfg_t cfg;
+    touch_filter_axis_t x;
+    touch_filter_axis_t y;
+    int64_t last_us;
+    bool primed;
+} touch_filter_t;
+
+void touch_filter_init(touch_filter_t *f, const touch_filter_cfg_t *cfg);
+
+/* Палец отпущен или сменился: следующая точка начнёт фильтр заново */
+void touch_filter_reset(touch_filter_t *f);
+
+/**
+ * @brief Отфильтровать точку на месте
+ * @param t_us время отсчёта, мкс (монотонное)
+ */
+void touch_filter_apply(touch_filter_t *f, int64_t t_us, int16_t *x, int16_t *y);
@@ -0,0 +1,224 @@
+/**
+ * @file touch_gesture.c
+ * @brief Щипок, поворот, свайп двумя пальцами и долгое нажатие
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "touch_gesture.h"
+
+/* Пороги, после которых двухпальцевый жест закрепляется */
+#define PINCH_SLOP_PX           24
+#define ROTATE_SLOP_DDEG        100
+#define SWIPE_SLOP_PX           30
+/* Шаг выдачи событий по ходу жеста */
+#define PINCH_STEP_Q8           8       /* ~3% */
+#define ROTATE_STEP_DDEG        20
+/* Свайп: сдвиг центра и время от касания до отрыва */
+#define SWIPE_MIN_PX            80
+#define SWIPE_MAX_US            600000
+/* Долгое нажатие: палец не ушёл дальше LONG_PRESS_SLOP_PX */
+#define LONG_PRESS_US           600000
+#define LONG_PRESS_SLOP_PX      12
+
+static uint32_t isqrt(uint32_t v)
+{
+    uint32_t r = 0;
+    for (uint32_t bit = 1u << 30; bit; bit >>= 2) {
+        if (v >= r + bit) {
+            v -= r + bit;
+            r = (r >> 1) + bit;
+        } else {
+            r >>= 1;
+        }
+    }
+    return r;
+}
+
+/* atan2 в десятых градуса, -1800..1800, ошибка меньше 0.1°:
+ * atan(z) ≈ 45z - z(z - 1)(14.02 + 3.79z) градусов на [0, 1] */
+static int32_t atan2_ddeg(int32_t y, int32_t x)
+{
+    uint32_t ax = (uint32_t)abs(x);
+    uint32_t ay = (uint32_t)abs(y);
+    if (ax == 0 && ay == 0) {
+        return 0;
+    }
+    uint32_t mn = ax < ay ? ax : ay;
+    uint32_t mx = ax < ay ? ay : ax;
+    int64_t z = ((int64_t)mn << 15) / mx;                  /* Q15 */
+    int64_t poly = (1402LL * 32768 + 379 * z) / 10;        /* 14.02 + 3.79z, Q15 */
+    int64_t zz1 = (z * (z - 32768)) >> 15;                 /* z(z - 1), Q15 */
+    int32_t a = (int32_t)((450 * z - ((zz1 * poly) >> 15)) >> 15);
+
+    if (ay > ax) a = 900 - a;
+    if (x < 0) a = 1800 - a;
+    if (y < 0) a = -a;
+    return a;
+}
+
+static int32_t wrap_ddeg(int32_t a)
+{
+    while (a > 1800) a -= 3600;
+    while (a <= -1800) a += 3600;
+    return a;
+}
+
+static const touch_contact_t *find_id(const touch_contact_t *contacts, uint8_t count, uint8_t id)
+{
+    for (uint8_t i = 0; i < count; i++) {
+        if (contacts[i].id == id) {
+            return &contacts[i];
+        }
+    }
+    return NULL;
+}
+
+static bool pair_release(touch_gesture_rec_t *r, int64_t t_us, touch_gesture_t *out)
+{
+    r->pair_active = false;
+    if (r->pair_type != TOUCH_GESTURE_SWIPE || t_us - r->pair_start_us > SWIPE_MAX_US) {
+        return false;
+    }
+    int32_t dx = r->cx - r->start_cx;
+    int32_t dy = r->cy - r->start_cy;
+    if (abs(dx) < SWIPE_MIN_PX && abs(dy) < SWIPE_MIN_PX) {
+        return false;
+    }
+    out->type = TOUCH_GESTURE_SWIPE;
+    out->dir = abs(dx) > abs(dy) ? (dx > 0 ? TOUCH_SWIPE_RIGHT : TOUCH_SWIPE_LEFT)
+                                 : (dy > 0 ? TOUCH_SWIPE_DOWN : TOUCH_SWIPE_UP);
+    out->x = r->cx;
+    out->y = r->cy;
+    return true;
+}
+
+static bool pair_update(touch_gesture_rec_t *r, int64_t t_us, const touch_contact_t *a, const touch_contact_t *b,
+                        touch_gesture_t *out)
+{
+    int32_t vx = b->x - a->x;
+    int32_t vy = b->y - a->y;
+    int32_t dist = (int32_t)isqrt((uint32_t)(vx * vx + vy * vy));
+    int32_t angle = atan2_ddeg(vy, vx);
+    r->cx = (int16_t)((a->x + b->x) / 2);
+    r->cy = (int16_t)((a->y + b->y) / 2);
+
+    if (!r->pair_active) {
+        r->pair_active = true;
+        r->pair_id[0] = a->id;
+        r->pair_id[1] = b->id;
+        r->pair_type = TOUCH_GESTURE_NONE;
+        r->pair_start_us = t_us;
+        r->start_dist = dist > 0 ? dist : 1;
+        r->start_angle = angle;
+        r->start_cx = r->cx;
+        r->start_cy = r->cy;
+        r->emitted_scale_q8 = 256;
+        r->emitted_angle = angle;
+        return false;
+    }
+
+    int32_t rot = wrap_ddeg(angle - r->start_angle);
+    if (r->pair_type == TOUCH_GESTURE_NONE) {
+        if (abs(dist - r->start_dist) > PINCH_SLOP_PX) {
+            r->pair_type = TOUCH_GESTURE_PINCH;
+        } else if (abs(rot) > ROTATE_SLOP_DDEG) {
+            r->pair_type = TOUCH_GESTURE_ROTATE;
+        } else if (abs(r->cx - r->start_cx) > SWIPE_SLOP_PX || abs(r->cy - r->start_cy) > SWIPE_SLOP_PX) {
+            r->pair_type = TOUCH_GESTURE_SWIPE;
+        }
+    }
+
+    out->x = r->cx;
+    out->y = r->cy;
+    if (r->pair_type == TOUCH_GESTURE_PINCH) {
+        int32_t scale = dist * 256 / r->start_dist;
+        if (abs(scale - r->emitted_scale_q8) >= PINCH_STEP_Q8) {
+            r->emitted_scale_q8 = scale;
+            out->type = TOUCH_GESTURE_PINCH;
+            out->scale_q8 = scale;
+            return true;
+        }
+    } else if (r->pair_type == TOUCH_GESTURE_ROTATE) {
+        int32_t delta = wrap_ddeg(angle - r->emitted_angle);
+        if (abs(delta) >= ROTATE_STEP_DDEG) {
+            r->emitted_angle = angle;
+            out->type = TOUCH_GESTURE_ROTATE;
+            out->angle_ddeg = delta;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool press_update(touch_gesture_rec_t *r, int64_t t_us, const touch_contact_t *c, touch_gesture_t *out)
+{
+    if (!r->press_active || r->press_id != c->id) {
+        r->press_active = true;
+        r->press_done = false;
+        r->press_start_us = t_us;
+        r->press_x = c->x;
+        r->press_y = c->y;
+        r->press_id = c->id;
+        return false;
+    }
+    if (r->press_done) {
+        return false;
+    }
+    if (abs(c->x - r->press_x) > LONG_PRESS_SLOP_PX || abs(c->y - r->press_y) > LONG_PRESS_SLOP_PX) {
+        r->press_done = true; /* палец поехал — это уже не долгое нажатие */
+        return false;
+    }
+    if (t_us - r->press_start_us < LONG_PRESS_US) {
+        return false;
+    }
+    r->press_done = true;
+    out->type = TOUCH_GESTURE_LONG_PRESS;
+    out->x = c->x;
+    out->y = c->y;
+    return true;
+}
+
+void touch_gesture_init(touch_gesture_rec_t *r)
+{
+    memset(r, 0, sizeof(*r));
+}
+
+bool touch_gesture_update(touch_gesture_rec_t *r, int64_t t_us, const touch_contact_t *contacts, uint8_t count,
+                          touch_gesture_t *out)
+{
+    memset(out, 0, sizeof(*out));
+
+    if (count >= 2) {
+        r->press_active = false;
+        const touch_contact_t *a = &contacts[0];
+        const touch_contact_t *b = &contacts[1];
+        if (r->pair_active) {
+            a = find_id(contacts, count, r->pair_id[0]);
+            b = find_id(contacts, count, r->pair_id[1]);
+            if (a == NULL || b == NULL) {
+                /* Один из пары оторван, вместо него другой палец — жест закончен */
+                return pair_release(r, t_us, out);
+            }
+        }
+        return pair_update(r, t_us, a, b, out);
+    }
+
+    if (r->pair_active) {
+        /* Пальцы отрываются не одновременно: до полного отрыва новый жест не начинаем */
+        bool done = pair_release(r, t_us, out);
+        r->press_active = count == 1;
+        r->press_done = true;
+        if (count == 1) {
+            r->press_id = contacts[0].id;
+        }
+        return done;
+    }
+
+    if (count == 1) {
+        return press_update(r, t_us, &contacts[0], out);
+    }
+
+    r->press_active = false;
+    return false;
+}
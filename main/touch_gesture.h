@@ -0,0 +1,82 @@
+/**
+ * @file touch_gesture.h
+ * @brief Распознавание жестов по отсчётам multi-touch
+ *
+ * Работает по одному отсчёту за вызов, за O(число контактов), без кучи.
+ * Двухпальцевые жесты берут первые два контакта и следят за ними по track id:
+ * после порога жест закрепляется как щипок, поворот или свайп и дальше не
+ * перескакивает. Щипок и поворот выдаются по ходу движения, свайп — при
+ * отрыве пальцев, долгое нажатие — один раз, пока палец стоит.
+ *
+ * Модуль не зависит от ESP-IDF и LVGL и собирается на хосте.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Один контакт кадра GT911 */
+typedef struct {
+    int16_t x;
+    int16_t y;
+    uint16_t size;
+    uint8_t id;             /* track id: один палец — один id, пока не оторван */
+} touch_contact_t;
+
+typedef enum {
+    TOUCH_GESTURE_NONE = 0,
+    TOUCH_GESTURE_PINCH,        /* scale_q8 от начала жеста */
+    TOUCH_GESTURE_ROTATE,       /* angle_ddeg с прошлого события */
+    TOUCH_GESTURE_SWIPE,        /* двумя пальцами, dir */
+    TOUCH_GESTURE_LONG_PRESS,   /* одним пальцем */
+} touch_gesture_type_t;
+
+typedef enum {
+    TOUCH_SWIPE_LEFT,
+    TOUCH_SWIPE_RIGHT,
+    TOUCH_SWIPE_UP,
+    TOUCH_SWIPE_DOWN,
+} touch_swipe_dir_t;
+
+typedef struct {
+    touch_gesture_type_t type;
+    int32_t scale_q8;           /* расстояние между пальцами к начальному, 256 = 1.0 */
+    int32_t angle_ddeg;         /* десятые градуса, + по часовой стрелке на экране */
+    touch_swipe_dir_t dir;
+    int16_t x;                  /* центр жеста */
+    int16_t y;
+} touch_gesture_t;
+
+typedef struct {
+    /* Двухпальцевый жест */
+    bool pair_active;
+    uint8_t pair_id[2];
+    touch_gesture_type_t pair_type;
+    int64_t pair_start_us;
+    int32_t start_dist;
+    int32_t start_angle;
+    int16_t start_cx;
+    int16_t start_cy;
+    int16_t cx;
+    int16_t cy;
+    int32_t emitted_scale_q8;
+    int32_t emitted_angle;
+    /* Долгое нажатие */
+    bool press_active;
+    bool press_done;
+    uint8_t press_id;
+    int64_t press_start_us;
+    int16_t press_x;
+    int16_t press_y;
+} touch_gesture_rec_t;
+
+void touch_gesture_init(touch_gesture_rec_t *r);
+
+/**
+ * @brief Учесть отсчёт
+ * @param contacts контакты кадра, count == 0 — все пальцы отпущены
+ * @return true, если в out записан жест
+ */
+bool touch_gesture_update(touch_gesture_rec_t *r, int64_t t_us, const touch_contact_t *contacts, uint8_t count,
+                          touch_gesture_t *out);
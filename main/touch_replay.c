@@ -0,0 +1,287 @@
+/**
+ * @file touch_replay.c
+ * @brief Буфер трассы, запись из задачи тача и воспроизведение в неё
+ */
+
+#include "touch_replay.h"
+#include "sdkconfig.h"
+
+#if CONFIG_TOUCH_TRACE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_console.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "display.h"
+#include "touch.h"
+#include "touch_trace.h"
+
+static const char *TAG = "TRACE";
+
+#define TRACE_BUF_SIZE          (CONFIG_TOUCH_TRACE_BUF_KB * 1024)
+#define TRACE_PLAY_TASK_PRIO    3
+#define TRACE_PLAY_TASK_STACK   4096
+/* Задача тача не взяла кадр за это время — считаем, что она не работает */
+#define TRACE_INJECT_TIMEOUT_MS 1000
+/* После последнего кадра: кольцо разобрано, ждём кадр UI по нему */
+#define TRACE_SETTLE_MS         100
+#define TRACE_DUMP_LINE         32
+
+static uint8_t *s_buf = NULL;
+static size_t s_len = 0;
+
+static volatile bool s_recording = false;
+static bool s_rec_started = false;
+static int64_t s_rec_t0;
+static int64_t s_rec_prev;
+static uint32_t s_rec_frames;
+
+static volatile bool s_playing = false;
+static volatile bool s_play_abort = false;
+
+static bool buf_alloc(void)
+{
+    if (s_buf == NULL) {
+        s_buf = heap_caps_malloc(TRACE_BUF_SIZE, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (s_buf == NULL) {
+            ESP_LOGE(TAG, "No PSRAM for %u-byte trace buffer", (unsigned)TRACE_BUF_SIZE);
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Задача тача: сырой кадр GT911 */
+static void record_hook(const touch_trace_frame_t *f)
+{
+    touch_trace_frame_t rel = *f;
+    if (!s_rec_started) {
+        s_rec_started = true;
+        s_rec_t0 = f->t_us;
+        s_rec_prev = 0;
+    }
+    rel.t_us = f->t_us - s_rec_t0;
+
+    size_t n = touch_trace_encode(s_buf + s_len, TRACE_BUF_SIZE - s_len, s_rec_prev, &rel);
+    if (n == 0) {
+        touch_set_frame_hook(NULL);
+        s_recording = false;
+        ESP_LOGW(TAG, "Trace buffer full after %u frames", (unsigned)s_rec_frames);
+        return;
+    }
+    s_len += n;
+    s_rec_prev = rel.t_us;
+    s_rec_frames++;
+}
+
+bool touch_replay_record_start(void)
+{
+    if (s_recording || s_playing || !buf_alloc()) {
+        return false;
+    }
+    s_len = touch_trace_write_header(s_buf);
+    s_rec_started = false;
+    s_rec_frames = 0;
+    s_recording = true;
+    touch_set_frame_hook(record_hook);
+    return true;
+}
+
+void touch_replay_record_stop(void)
+{
+    if (!s_recording) return;
+    touch_set_frame_hook(NULL);
+    s_recording = false;
+    /* Хук мог быть вызван в этот момент: дать задаче тача дописать кадр */
+    vTaskDelay(pdMS_TO_TICKS(CONFIG_TOUCH_POLL_PERIOD_MS));
+    ESP_LOGI(TAG, "Recorded %u frames, %u bytes", (unsigned)s_rec_frames, (unsigned)s_len);
+}
+
+size_t touch_replay_size(void)
+{
+    return s_len;
+}
+
+static void play_task(void *arg)
+{
+    const bool realtime = arg != NULL;
+    touch_trace_frame_t f;
+    int64_t prev = 0;
+    uint32_t frames = 0;
+    size_t pos = TOUCH_TRACE_HEADER_SIZE;
+
+    touch_set_replay(true);
+    display_reset_frame_stats();
+    int64_t start_us = esp_timer_get_time();
+
+    while (!s_play_abort) {
+        size_t n = touch_trace_decode(s_buf + pos, s_len - pos, prev, &f);
+        if (n == 0) {
+            break;
+        }
+        pos += n;
+        prev = f.t_us;
+
+        /* Метки из трассы, сдвинутые к началу воспроизведения: интервалы те же */
+        f.t_us += start_us;
+        if (realtime) {
+            int64_t wait_us = f.t_us - esp_timer_get_time();
+            if (wait_us > 0) {
+                vTaskDelay((TickType_t)((wait_us * configTICK_RATE_HZ + 999999) / 1000000));
+            }
+        }
+        if (!touch_inject_frame(&f, TRACE_INJECT_TIMEOUT_MS)) {
+            ESP_LOGE(TAG, "Touch task does not take frames, replay aborted");
+            break;
+        }
+        frames++;
+    }
+
+    for (int i = 0; i < TRACE_SETTLE_MS / 10 && touch_ring_count() > 0; i++) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    vTaskDelay(pdMS_TO_TICKS(TRACE_SETTLE_MS));
+    int64_t elapsed_us = esp_timer_get_time() - start_us;
+    touch_set_replay(false);
+
+    display_frame_stats_t stats;
+    display_get_frame_stats(&stats);
+    ESP_LOGI(TAG, "Replay %s: %u frames of %lld ms trace in %lld ms",
+             realtime ? "realtime" : "fast", (unsigned)frames, (long long)(prev / 1000),
+             (long long)(elapsed_us / 1000));
+    ESP_LOGI(TAG, "UI: %u frames, render avg %u us, max %u us; invalidated %llu px, %u px/frame",
+             (unsigned)stats.frames, (unsigned)(stats.frames ? stats.render_us / stats.frames : 0),
+             (unsigned)stats.render_us_max, (unsigned long long)stats.inv_px,
+             (unsigned)(stats.frames ? stats.inv_px / stats.frames : 0));
+
+    s_playing = false;
+    vTaskDelete(NULL);
+}
+
+bool touch_replay_play(bool realtime)
+{
+    if (s_recording || s_playing || s_buf == NULL || !touch_trace_check_header(s_buf, s_len)) {
+        return false;
+    }
+    s_playing = true;
+    s_play_abort = false;
+    if (xTaskCreate(play_task, "trace_play", TRACE_PLAY_TASK_STACK, realtime ? (void *)1 : NULL,
+                    TRACE_PLAY_TASK_PRIO, NULL) != pdPASS) {
+        s_playing = false;
+        return false;
+    }
+    return true;
+}
+
+static int hex_nibble(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+/* Дописать hex-кусок; первый кусок должен начинаться с заголовка */
+static bool load_hex(const char *hex)
+{
+    if (!buf_alloc()) return false;
+    size_t len = strlen(hex);
+    size_t start = s_len;
+    if (len % 2 != 0 || start + len / 2 > TRACE_BUF_SIZE) {
+        return false;
+    }
+    for (size_t i = 0; i < len; i += 2) {
+        int hi = hex_nibble(hex[i]);
+        int lo = hex_nibble(hex[i + 1]);
+        if (hi < 0 || lo < 0) {
+            s_len = start;
+            return false;
+        }
+        s_buf[s_len++] = (uint8_t)((hi << 4) | lo);
+    }
+    /* Без заголовка в начале буфера play всё равно откажет — лучше сразу */
+    if (start == 0 && !touch_trace_check_header(s_buf, s_len)) {
+        s_len = 0;
+        return false;
+    }
+    return true;
+}
+
+static void dump_hex(void)
+{
+    for (size_t i = 0; i < s_len; i += TRACE_DUMP_LINE) {
+        size_t n = s_len - i < TRACE_DUMP_LINE ? s_len - i : TRACE_DUMP_LINE;
+        for (size_t j = 0; j < n; j++) {
+            printf("%02x", s_buf[i + j]);
+        }
+        printf("\n");
+    }
+}
+
+static int trace_cmd(int argc, char **argv)
+{
+    const char *op = argc > 1 ? argv[1] : "info";
+    bool busy = s_recording || s_playing;
+
+    if (strcmp(op, "rec") == 0) {
+        if (!touch_replay_record_start()) {
+            printf("busy or no memory\n");
+            return 1;
+        }
+    } else if (strcmp(op, "stop") == 0) {
+        touch_replay_record_stop();
+        s_play_abort = true;
+    } else if (strcmp(op, "play") == 0) {
+        bool realtime = !(argc > 2 && strcmp(argv[2], "fast") == 0);
+        if (!touch_replay_play(realtime)) {
+            printf("busy or no valid trace\n");
+            return 1;
+        }
+    } else if (busy) {
+        printf("busy\n");
+        return 1;
+    } else if (strcmp(op, "dump") == 0) {
+        dump_hex();
+    } else if (strcmp(op, "clear") == 0) {
+        s_len = 0;
+    } else if (strcmp(op, "load") == 0 && argc > 2) {
+        if (!load_hex(argv[2])) {
+            printf("bad hex, no T1TR header or buffer full\n");
+            return 1;
+        }
+    } else if (strcmp(op, "info") == 0) {
+        printf("%u of %u bytes%s%s\n", (unsigned)s_len, (unsigned)TRACE_BUF_SIZE,
+               s_recording ? ", recording" : "", s_playing ? ", playing" : "");
+    } else {
+        printf("usage: trace rec|stop|play [fast]|dump|load <hex>|clear|info\n");
+        return 1;
+    }
+    return 0;
+}
+
+void touch_replay_register_cmd(void)
+{
+    const esp_console_cmd_t cmd = {
+        .command = "trace",
+        .help = "Record, replay and transfer raw GT911 traces. "
+                "'trace dump | xxd -r -p' on the host gives the trace file",
+        .hint = "rec|stop|play [fast]|dump|load <hex>|clear|info",
+        .func = &trace_cmd,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&cmd));
+}
+
+#else
+
+bool touch_replay_record_start(void) { return false; }
+void touch_replay_record_stop(void) {}
+bool touch_replay_play(bool realtime) { (void)realtime; return false; }
+size_t touch_replay_size(void) { return 0; }
+void touch_replay_register_cmd(void) {}
+
+#endif
@@ -0,0 +1,38 @@
+/**
+ * @file touch_replay.h
+ * @brief Запись и воспроизведение трассы тача (формат touch_trace.h)
+ *
+ * Трасса лежит в буфере PSRAM на CONFIG_TOUCH_TRACE_BUF_KB. Запись берёт
+ * сырые кадры GT911 из задачи тача, воспроизведение отдаёт их обратно в
+ * задачу тача вместо GT911 — дальше тот же путь до touchpad_read_cb().
+ * Метки времени берутся из трассы, поэтому фильтр и жесты видят те же
+ * интервалы и в реальном времени, и без пауз. Таймеры и анимации LVGL идут
+ * по lv_tick, а не по трассе: кадры UI между прогонами совпадают не бит в бит.
+ *
+ * С хостом трасса ходит через консоль: «trace dump» печатает её hex-строками
+ * (xxd -r -p собирает файл), «trace load <hex>» дописывает кусок в буфер.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+bool touch_replay_record_start(void);
+void touch_replay_record_stop(void);
+
+/**
+ * @brief Воспроизвести трассу из буфера в отдельной задаче
+ * @param realtime true — с записанными интервалами, false — без пауз
+ *
+ * По окончании в лог идёт отчёт: кадры трассы, кадры UI, время рендера
+ * и площадь перерисовки. Счётчики кадров дисплея при старте сбрасываются.
+ */
+bool touch_replay_play(bool realtime);
+
+/* Байт трассы в буфере, с заголовком */
+size_t touch_replay_size(void);
+
+/* Команда консоли «trace» */
+void touch_replay_register_cmd(void);
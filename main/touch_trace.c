@@ -0,0 +1,100 @@
+/**
+ * @file touch_trace.c
+ * @brief Кодирование и разбор трассы сырых кадров GT911
+ */
+
+#include <string.h>
+#include "touch_trace.h"
+
+static const uint8_t trace_magic[4] = { 'T', '1', 'T', 'R' };
+
+size_t touch_trace_write_header(uint8_t *dst)
+{
+    memset(dst, 0, TOUCH_TRACE_HEADER_SIZE);
+    memcpy(dst, trace_magic, sizeof(trace_magic));
+    dst[4] = TOUCH_TRACE_VERSION;
+    return TOUCH_TRACE_HEADER_SIZE;
+}
+
+bool touch_trace_check_header(const uint8_t *src, size_t len)
+{
+    return len >= TOUCH_TRACE_HEADER_SIZE && memcmp(src, trace_magic, sizeof(trace_magic)) == 0
+        && src[4] == TOUCH_TRACE_VERSION;
+}
+
+static void put16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static uint16_t get16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+size_t touch_trace_encode(uint8_t *dst, size_t cap, int64_t prev_t_us, const touch_trace_frame_t *f)
+{
+    uint8_t rec[TOUCH_TRACE_RECORD_MAX];
+    size_t n = 0;
+    int64_t dt = f->t_us - prev_t_us;
+    /* Разрыв длиннее 71 минуты — не важен для воспроизведения, обрезаем */
+    uint32_t v = dt <= 0 ? 0 : dt > UINT32_MAX ? UINT32_MAX : (uint32_t)dt;
+    do {
+        rec[n++] = (uint8_t)((v & 0x7F) | (v > 0x7F ? 0x80 : 0));
+        v >>= 7;
+    } while (v);
+
+    uint8_t count = f->count > TOUCH_TRACE_MAX_POINTS ? TOUCH_TRACE_MAX_POINTS : f->count;
+    rec[n++] = count;
+    for (uint8_t i = 0; i < count; i++) {
+        const touch_contact_t *c = &f->contacts[i];
+        rec[n] = c->id;
+        put16(rec + n + 1, (uint16_t)c->x);
+        put16(rec + n + 3, (uint16_t)c->y);
+        put16(rec + n + 5, c->size);
+        n += TOUCH_TRACE_POINT_SIZE;
+    }
+
+    if (n > cap) {
+        return 0;
+    }
+    memcpy(dst, rec, n);
+    return n;
+}
+
+size_t touch_trace_decode(const uint8_t *src, size_t len, int64_t prev_t_us, touch_trace_frame_t *f)
+{
+    size_t n = 0;
+    uint32_t dt = 0;
+    for (unsigned shift = 0;; shift += 7) {
+        if (n >= len || shift > 28) {
+            return 0;
+        }
+        uint8_t b = src[n++];
+        dt |= (uint32_t)(b & 0x7F) << shift;
+        if ((b & 0x80) == 0) {
+            break;
+        }
+    }
+
+    if (n >= len) {
+        return 0;
+    }
+    uint8_t count = src[n++];
+    if (count > TOUCH_TRACE_MAX_POINTS || len - n < (size_t)count * TOUCH_TRACE_POINT_SIZE) {
+        return 0;
+    }
+
+    f->t_us = prev_t_us + dt;
+    f->count = count;
+    for (uint8_t i = 0; i < count; i++) {
+        touch_contact_t *c = &f->contacts[i];
+        c->id = src[n];
+        c->x = (int16_t)get16(src + n + 1);
+        c->y = (int16_t)get16(src + n + 3);
+        c->size = get16(src + n + 5);
+        n += TOUCH_TRACE_POINT_SIZE;
+    }
+    return n;
+}
@@ -0,0 +1,50 @@
+/**
+ * @file touch_trace.h
+ * @brief Формат записи сырых кадров GT911
+ *
+ * Файл: заголовок "T1TR", версия, три резервных байта; дальше записи
+ * подряд. Запись: интервал от прошлого кадра в мкс (LEB128), число точек,
+ * по 7 байт на точку — track id, X, Y, размер (uint16 little-endian), как
+ * их прислал GT911, до калибровки и фильтра. Кадр из одной точки — 9..13
+ * байт, минута непрерывного жеста при 100 Гц — около 60 КБ.
+ *
+ * Модуль не зависит от ESP-IDF и LVGL и собирается на хосте.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "touch_gesture.h"
+
+#define TOUCH_TRACE_VERSION     1
+#define TOUCH_TRACE_HEADER_SIZE 8
+#define TOUCH_TRACE_MAX_POINTS  5
+#define TOUCH_TRACE_POINT_SIZE  7
+#define TOUCH_TRACE_RECORD_MAX  (5 + 1 + TOUCH_TRACE_MAX_POINTS * TOUCH_TRACE_POINT_SIZE)
+
+/* Сырой кадр: точки в координатах GT911 */
+typedef struct {
+    int64_t t_us;           /* от начала трассы (в файле — разности) */
+    uint8_t count;
+    touch_contact_t contacts[TOUCH_TRACE_MAX_POINTS];
+} touch_trace_frame_t;
+
+/* Записать заголовок, вернуть его размер */
+size_t touch_trace_write_header(uint8_t *dst);
+
+/* false — не трасса или версия не та */
+bool touch_trace_check_header(const uint8_t *src, size_t len);
+
+/**
+ * @brief Закодировать кадр
+ * @param prev_t_us t_us предыдущего кадра (0 для первого)
+ * @return байт записано, 0 — не хватило cap
+ */
+size_t touch_trace_encode(uint8_t *dst, size_t cap, int64_t prev_t_us, const touch_trace_frame_t *f);
+
+/**
+ * @brief Раскодировать кадр
+ * @return байт прочитано, 0 — конец данных или запись повреждена
+ */
+size_t touch_trace_decode(const uint8_t *src, size_t len, int64_t prev_t_us, touch_trace_frame_t *f);
@@ -0,0 +1,611 @@
+/**
+ * @file ui_bench.c
+ * @brief Прогон сценариев по UI термостата, отчёт по кадрам и проверка перерисовки
+ */
+
+#include "ui_bench.h"
+
+#if CONFIG_UI_BENCH
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#if CONFIG_APP_CONSOLE
+#include "esp_console.h"
+#endif
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "display.h"
+#include "display/lv_display_private.h"
+
+static const char *TAG = "BENCH";
+
+#define BENCH_FRAMES_MAX        256
+#define BENCH_TASK_PRIO         3
+#define BENCH_TASK_STACK        6144
+/* Шаг без изменений на экране кадра не даёт — не ждём его вечно */
+#define BENCH_FRAME_TIMEOUT_MS  200
+/* Кадры подготовки сценария в отчёт не идут */
+#define BENCH_SETTLE_MS         100
+#define BENCH_IDLE_MS           3000
+#define BENCH_ARC_MIN           150
+#define BENCH_ARC_MAX           300
+#define BENCH_REDRAWS           60
+#define BENCH_FLIPS             60
+
+#if CONFIG_DISPLAY_RENDER_MODE_DIRECT
+#define BENCH_RENDER_MODE       "direct"
+#elif CONFIG_DISPLAY_RENDER_MODE_PARTIAL
+#define BENCH_RENDER_MODE       "partial"
+#else
+#define BENCH_RENDER_MODE       "full"
+#endif
+
+typedef struct {
+    uint32_t render_us;
+    uint32_t inv_px;
+    uint32_t draw_tasks;
+} bench_frame_t;
+
+typedef struct {
+    const char *name;
+    void (*prep)(void);             /* под блокировкой, до успокоения */
+    void (*step)(uint32_t i);       /* под блокировкой, затем ждём кадр */
+    uint32_t steps;
+    uint32_t run_ms;                /* без шагов: просто ждать */
+} bench_scenario_t;
+
+typedef struct {
+    uint32_t frames;
+    uint32_t render_us_mean;
+    uint32_t render_us_p99;
+    uint32_t render_us_max;
+    uint32_t inv_px_mean;
+    uint32_t inv_px_max;
+    uint32_t draw_tasks_mean;
+    uint32_t draw_tasks_max;
+    size_t lv_heap_used;
+    size_t lv_heap_max_used;        /* с запуска, общий для всех сценариев */
+} bench_result_t;
+
+static ui_bench_target_t s_target;
+static bool s_have_target = false;
+static volatile bool s_running = false;
+static const char *s_out_path = NULL;   /* NULL — stdout, без выхода */
+static SemaphoreHandle_t s_frame_sem = NULL;
+
+/* Пишет задача LVGL под блокировкой, читает задача прогона под ней же */
+static bench_frame_t s_frames[BENCH_FRAMES_MAX];
+static uint32_t s_frame_cnt;
+static int64_t s_render_start_us;
+static uint32_t s_render_px;
+static uint32_t s_draw_tasks;
+static uint32_t s_sorted[BENCH_FRAMES_MAX];
+
+static void bench_render_cb(lv_event_t *e)
+{
+    int64_t now = esp_timer_get_time();
+    if (lv_event_get_code(e) == LV_EVENT_RENDER_START) {
+        lv_display_t *disp = (lv_display_t *)lv_event_get_target(e);
+        s_render_px = 0;
+        for (uint32_t i = 0; i < disp->inv_p; i++) {
+            if (!disp->inv_area_joined[i]) {
+                s_render_px += lv_area_get_size(&disp->inv_areas[i]);
+            }
+        }
+        s_draw_tasks = 0;
+        s_render_start_us = now;
+    } else {
+        if (s_frame_cnt < BENCH_FRAMES_MAX) {
+            s_frames[s_frame_cnt] = (bench_frame_t){
+                .render_us = (uint32_t)(now - s_render_start_us),
+                .inv_px = s_render_px,
+                .draw_tasks = s_draw_tasks,
+            };
+        }
+        s_frame_cnt++;
+        xSemaphoreGive(s_frame_sem);
+    }
+}
+
+static void bench_draw_task_cb(lv_event_t *e)
+{
+    (void)e;
+    s_draw_tasks++;
+}
+
+/* Задачи рисования виджет сообщает, только если у него стоит флаг */
+static lv_obj_tree_walk_res_t draw_events_walk(lv_obj_t *obj, void *attach)
+{
+    if (attach) {
+        lv_obj_add_flag(obj, LV_OBJ_FLAG_SEND_DRAW_TASK_EVENTS);
+        lv_obj_add_event_cb(obj, bench_draw_task_cb, LV_EVENT_DRAW_TASK_ADDED, NULL);
+    } else {
+        lv_obj_remove_event_cb(obj, bench_draw_task_cb);
+        lv_obj_remove_flag(obj, LV_OBJ_FLAG_SEND_DRAW_TASK_EVENTS);
+    }
+    return LV_OBJ_TREE_WALK_NEXT;
+}
+
+static void bench_attach(bool attach)
+{
+    lv_display_t *disp = lv_display_get_default();
+    if (attach) {
+        lv_display_add_event_cb(disp, bench_render_cb, LV_EVENT_RENDER_START, NULL);
+        lv_display_add_event_cb(disp, bench_render_cb, LV_EVENT_RENDER_READY, NULL);
+    } else {
+        lv_display_remove_event_cb_with_user_data(disp, bench_render_cb, NULL);
+    }
+    lv_obj_tree_walk(lv_screen_active(), draw_events_walk, attach ? (void *)1 : NULL);
+}
+
+static void prep_default(void)
+{
+    lv_timer_pause(s_target.room_timer);
+    s_target.set_temps(225, 215);
+}
+
+static void prep_idle(void)
+{
+    s_target.set_temps(225, 215);
+    lv_timer_reset(s_target.room_timer);
+    lv_timer_resume(s_target.room_timer);
+}
+
+static void prep_arc(void)
+{
+    lv_timer_pause(s_target.room_timer);
+    s_target.set_temps(BENCH_ARC_MIN, 215);
+}
+
+/* Как протяжка пальцем: значение арки и событие, по которому main.c обновляет подписи */
+static void step_arc(uint32_t i)
+{
+    lv_arc_set_value(s_target.arc, (int32_t)(BENCH_ARC_MIN + 1 + i));
+    lv_obj_send_event(s_target.arc, LV_EVENT_VALUE_CHANGED, NULL);
+}
+
+static void step_redraw(uint32_t i)
+{
+    (void)i;
+    lv_obj_invalidate(lv_screen_active());
+}
+
+static void prep_flip(void)
+{
+    lv_timer_pause(s_target.room_timer);
+    s_target.set_temps(225, 225);
+}
+
+/* Уставка 22.5: комната 20.5 — HEATING, 24.5 — COOLING, 22.5 — HOLD */
+static void step_flip(uint32_t i)
+{
+    static const int32_t rooms[] = { 205, 245, 225 };
+    s_target.set_temps(225, rooms[i % 3]);
+}
+
+static const bench_scenario_t s_scenarios[] = {
+    { "idle", prep_idle, NULL, 0, BENCH_IDLE_MS },
+    { "arc_drag", prep_arc, step_arc, BENCH_ARC_MAX - BENCH_ARC_MIN, 0 },
+    { "full_redraw", prep_default, step_redraw, BENCH_REDRAWS, 0 },
+    { "state_flip", prep_flip, step_flip, BENCH_FLIPS, 0 },
+};
+
+static int cmp_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void summarize(bench_result_t *r)
+{
+    uint32_t n = s_frame_cnt < BENCH_FRAMES_MAX ? s_frame_cnt : BENCH_FRAMES_MAX;
+    uint64_t us = 0, px = 0, tasks = 0;
+    memset(r, 0, sizeof(*r));
+    r->frames = s_frame_cnt;
+    for (uint32_t i = 0; i < n; i++) {
+        const bench_frame_t *f = &s_frames[i];
+        us += f->render_us;
+        px += f->inv_px;
+        tasks += f->draw_tasks;
+        if (f->inv_px > r->inv_px_max) r->inv_px_max = f->inv_px;
+        if (f->draw_tasks > r->draw_tasks_max) r->draw_tasks_max = f->draw_tasks;
+        s_sorted[i] = f->render_us;
+    }
+    if (n > 0) {
+        qsort(s_sorted, n, sizeof(s_sorted[0]), cmp_u32);
+        r->render_us_mean = (uint32_t)(us / n);
+        r->render_us_p99 = s_sorted[(n * 99 + 99) / 100 - 1];
+        r->render_us_max = s_sorted[n - 1];
+        r->inv_px_mean = (uint32_t)(px / n);
+        r->draw_tasks_mean = (uint32_t)(tasks / n);
+    }
+#if LV_USE_STDLIB_MALLOC == LV_STDLIB_BUILTIN
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    r->lv_heap_used = mon.total_size - mon.free_size;
+    r->lv_heap_max_used = mon.max_used;
+#endif
+}
+
+static void run_scenario(const bench_scenario_t *sc, bench_result_t *r)
+{
+    display_lock(DISPLAY_LOCK_FOREVER);
+    sc->prep();
+    display_unlock();
+    vTaskDelay(pdMS_TO_TICKS(BENCH_SETTLE_MS));
+
+    display_lock(DISPLAY_LOCK_FOREVER);
+    s_frame_cnt = 0;
+    display_unlock();
+
+    if (sc->step == NULL) {
+        vTaskDelay(pdMS_TO_TICKS(sc->run_ms));
+    }
+    for (uint32_t i = 0; sc->step && i < sc->steps; i++) {
+        display_lock(DISPLAY_LOCK_FOREVER);
+        /* Под блокировкой кадр не рисуется: сигнал после неё — кадр с этим шагом */
+        (void)xSemaphoreTake(s_frame_sem, 0);
+        sc->step(i);
+        display_unlock();
+        (void)xSemaphoreTake(s_frame_sem, pdMS_TO_TICKS(BENCH_FRAME_TIMEOUT_MS));
+    }
+
+    display_lock(DISPLAY_LOCK_FOREVER);
+    lv_timer_pause(s_target.room_timer);
+    summarize(r);
+    display_unlock();
+}
+
+static void print_report(FILE *f, const bench_result_t *res)
+{
+    fprintf(f, "{\"target\":\"%s\",\"render_mode\":\"%s\",\"lvgl\":\"%d.%d.%d\",\"scenarios\":[",
+            CONFIG_IDF_TARGET, BENCH_RENDER_MODE, LVGL_VERSION_MAJOR, LVGL_VERSION_MINOR, LVGL_VERSION_PATCH);
+    for (size_t i = 0; i < sizeof(s_scenarios) / sizeof(s_scenarios[0]); i++) {
+        const bench_result_t *r = &res[i];
+        fprintf(f, "%s\n{\"name\":\"%s\",\"frames\":%u,\"render_us_mean\":%u,\"render_us_p99\":%u,"
+                "\"render_us_max\":%u,\"inv_px_mean\":%u,\"inv_px_max\":%u,\"draw_tasks_mean\":%u,"
+                "\"draw_tasks_max\":%u,\"lv_heap_used\":%u,\"lv_heap_max_used\":%u}",
+                i ? "," : "", s_scenarios[i].name, (unsigned)r->frames, (unsigned)r->render_us_mean,
+                (unsigned)r->render_us_p99, (unsigned)r->render_us_max, (unsigned)r->inv_px_mean,
+                (unsigned)r->inv_px_max, (unsigned)r->draw_tasks_mean, (unsigned)r->draw_tasks_max,
+                (unsigned)r->lv_heap_used, (unsigned)r->lv_heap_max_used);
+    }
+    fprintf(f, "\n]}\n");
+}
+
+#if CONFIG_IDF_TARGET_LINUX
+/* Проверка: что шагу позволено перерисовать */
+#define CHECK_ARC               (1u << 0)
+#define CHECK_SET               (1u << 1)
+#define CHECK_ROOM              (1u << 2)
+#define CHECK_STATE             (1u << 3)
+#define CHECK_OBJS              4
+#define CHECK_GOLDEN_MAX        32
+#define CHECK_NAME_MAX          32
+
+typedef struct {
+    const char *name;
+    void (*action)(void);           /* под блокировкой */
+    uint32_t may_redraw;            /* CHECK_*, 0 — кадра быть не должно */
+} check_step_t;
+
+typedef struct {
+    char name[CHECK_NAME_MAX];
+    uint32_t hash;
+} check_golden_t;
+
+static check_golden_t s_golden[CHECK_GOLDEN_MAX];
+static size_t s_golden_cnt = 0;
+
+static void act_labels_noop(void)
+{
+    s_target.set_temps(225, 215);
+}
+
+static void act_arc_noop(void)
+{
+    lv_obj_send_event(s_target.arc, LV_EVENT_VALUE_CHANGED, NULL);
+}
+
+static void act_setpoint_up(void)
+{
+    lv_arc_set_value(s_target.arc, 226);
+    lv_obj_send_event(s_target.arc, LV_EVENT_VALUE_CHANGED, NULL);
+}
+
+static void act_room_step(void)
+{
+    s_target.set_temps(226, 216);
+}
+
+static void act_to_hold(void)
+{
+    s_target.set_temps(226, 226);
+}
+
+static void act_to_cooling(void)
+{
+    s_target.set_temps(226, 240);
+}
+
+static void act_setpoint_jump(void)
+{
+    s_target.set_temps(300, 240);
+}
+
+/* Начало — уставка 22.5, комната 21.5 (HEATING), таймер комнаты на паузе */
+static const check_step_t s_check_steps[] = {
+    { "labels_noop", act_labels_noop, 0 },
+    { "arc_noop", act_arc_noop, 0 },
+    { "setpoint_up", act_setpoint_up, CHECK_ARC | CHECK_SET },
+    { "room_step", act_room_step, CHECK_ROOM },
+    { "to_hold", act_to_hold, CHECK_ROOM | CHECK_STATE },
+    { "to_cooling", act_to_cooling, CHECK_ROOM | CHECK_STATE },
+    { "setpoint_jump", act_setpoint_jump, CHECK_ARC | CHECK_SET | CHECK_STATE },
+};
+
+/* Области виджетов с учётом выноса рисования (тень, индикатор арки) */
+static void check_coords(lv_area_t out[CHECK_OBJS])
+{
+    lv_obj_t *objs[CHECK_OBJS] = { s_target.arc, s_target.label_set, s_target.label_room, s_target.label_state };
+    for (int i = 0; i < CHECK_OBJS; i++) {
+        int32_t ext = lv_obj_get_ext_draw_size(objs[i]);
+        lv_obj_get_coords(objs[i], &out[i]);
+        lv_area_increase(&out[i], ext, ext);
+    }
+}
+
+/* LVGL сливает области, только если это не больше их суммы: перерисовка
+ * шага не больше суммы охватов «до» и «после» разрешённых виджетов */
+static uint32_t check_bound(uint32_t mask, const lv_area_t before[CHECK_OBJS], const lv_area_t after[CHECK_OBJS])
+{
+    uint32_t bound = 0;
+    for (int i = 0; i < CHECK_OBJS; i++) {
+        if (!(mask & (1u << i))) continue;
+        lv_area_t u = {
+            .x1 = LV_MIN(before[i].x1, after[i].x1),
+            .y1 = LV_MIN(before[i].y1, after[i].y1),
+            .x2 = LV_MAX(before[i].x2, after[i].x2),
+            .y2 = LV_MAX(before[i].y2, after[i].y2),
+        };
+        bound += lv_area_get_size(&u);
+    }
+    return bound;
+}
+
+static bool check_load_golden(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (f == NULL) return false;
+    char line[128];
+    while (fgets(line, sizeof(line), f) && s_golden_cnt < CHECK_GOLDEN_MAX) {
+        check_golden_t *g = &s_golden[s_golden_cnt];
+        unsigned hash;
+        if (line[0] == '#') continue;
+        if (sscanf(line, "%31s %x", g->name, &hash) == 2) {
+            g->hash = hash;
+            s_golden_cnt++;
+        }
+    }
+    fclose(f);
+    return true;
+}
+
+static const check_golden_t *check_find_golden(const char *name)
+{
+    for (size_t i = 0; i < s_golden_cnt; i++) {
+        if (strcmp(s_golden[i].name, name) == 0) return &s_golden[i];
+    }
+    return NULL;
+}
+
+/* Прогон шагов; с record — эталоны хешей пишутся в path, иначе сверяются */
+static bool check_run(const char *path, bool record)
+{
+    const size_t n = sizeof(s_check_steps) / sizeof(s_check_steps[0]);
+    uint32_t hashes[sizeof(s_check_steps) / sizeof(s_check_steps[0])];
+    bool ok = true;
+
+    if (!record && !check_load_golden(path)) {
+        ESP_LOGE(TAG, "No golden file %s, record it with T1_CHECK_RECORD=1", path);
+        return false;
+    }
+
+    display_lock(DISPLAY_LOCK_FOREVER);
+    lv_timer_pause(s_target.room_timer);
+    s_target.set_temps(225, 215);
+    display_unlock();
+    vTaskDelay(pdMS_TO_TICKS(BENCH_SETTLE_MS));
+
+    for (size_t i = 0; i < n; i++) {
+        const check_step_t *st = &s_check_steps[i];
+        lv_area_t before[CHECK_OBJS], after[CHECK_OBJS];
+
+        display_lock(DISPLAY_LOCK_FOREVER);
+        (void)xSemaphoreTake(s_frame_sem, 0);
+        check_coords(before);
+        s_frame_cnt = 0;
+        st->action();
+        display_unlock();
+        (void)xSemaphoreTake(s_frame_sem, pdMS_TO_TICKS(BENCH_FRAME_TIMEOUT_MS));
+
+        display_lock(DISPLAY_LOCK_FOREVER);
+        /* Координаты после кадра: раскладка пересчитывается при рендере */
+        check_coords(after);
+        uint32_t frames = s_frame_cnt;
+        uint32_t inv_px = 0;
+        for (uint32_t k = 0; k < frames && k < BENCH_FRAMES_MAX; k++) {
+            inv_px += s_frames[k].inv_px;
+        }
+        display_unlock();
+
+        uint32_t bound = check_bound(st->may_redraw, before, after);
+        hashes[i] = display_frame_hash();
+        const char *verdict = "ok";
+        if (inv_px > bound) {
+            verdict = "OVER-INVALIDATED";
+        } else if (!record) {
+            const check_golden_t *g = check_find_golden(st->name);
+            if (g == NULL) {
+                verdict = "NO GOLDEN";
+            } else if (g->hash != hashes[i]) {
+                verdict = "FRAME CHANGED";
+            }
+        }
+        if (strcmp(verdict, "ok") != 0) ok = false;
+        printf("CHECK %-14s frames=%u inv_px=%u bound=%u hash=%08x %s\n", st->name, (unsigned)frames,
+               (unsigned)inv_px, (unsigned)bound, (unsigned)hashes[i], verdict);
+    }
+
+    if (record) {
+        FILE *f = fopen(path, "w");
+        if (f == NULL) {
+            ESP_LOGE(TAG, "Cannot open %s", path);
+            return false;
+        }
+        fprintf(f, "# ui_bench check: frame hashes, render_mode %s, lvgl %d.%d.%d\n", BENCH_RENDER_MODE,
+                LVGL_VERSION_MAJOR, LVGL_VERSION_MINOR, LVGL_VERSION_PATCH);
+        for (size_t i = 0; i < n; i++) {
+            fprintf(f, "%s %08x\n", s_check_steps[i].name, (unsigned)hashes[i]);
+        }
+        fclose(f);
+        ESP_LOGI(TAG, "Golden hashes written to %s", path);
+    }
+    return ok;
+}
+
+static void check_task(void *arg)
+{
+    const char *path = (const char *)arg;
+    const char *rec = getenv("T1_CHECK_RECORD");
+    bool record = rec && rec[0] && rec[0] != '0';
+
+    display_lock(DISPLAY_LOCK_FOREVER);
+    bench_attach(true);
+    display_unlock();
+    bool ok = check_run(path, record);
+    printf("CHECK %s\n", ok ? "PASSED" : "FAILED");
+    fflush(stdout);
+    exit(ok ? 0 : 1);
+}
+#endif /* CONFIG_IDF_TARGET_LINUX */
+
+static void bench_task(void *arg)
+{
+    (void)arg;
+    static bench_result_t res[sizeof(s_scenarios) / sizeof(s_scenarios[0])];
+
+    display_lock(DISPLAY_LOCK_FOREVER);
+    int32_t setpoint = lv_arc_get_value(s_target.arc);
+    bench_attach(true);
+    display_unlock();
+
+    for (size_t i = 0; i < sizeof(s_scenarios) / sizeof(s_scenarios[0]); i++) {
+        ESP_LOGI(TAG, "Scenario %s", s_scenarios[i].name);
+        run_scenario(&s_scenarios[i], &res[i]);
+    }
+
+    display_lock(DISPLAY_LOCK_FOREVER);
+    bench_attach(false);
+    /* Уставка — как до прогона, комната заново стремится к ней */
+    s_target.set_temps(setpoint, 215);
+    lv_timer_resume(s_target.room_timer);
+    display_unlock();
+
+    FILE *out = stdout;
+    if (s_out_path && strcmp(s_out_path, "-") != 0) {
+        out = fopen(s_out_path, "w");
+        if (out == NULL) {
+            ESP_LOGE(TAG, "Cannot open %s", s_out_path);
+            out = stdout;
+        }
+    }
+    print_report(out, res);
+    if (out != stdout) {
+        fclose(out);
+        ESP_LOGI(TAG, "Report written to %s", s_out_path);
+    }
+    fflush(stdout);
+#if CONFIG_IDF_TARGET_LINUX
+    if (s_out_path) {
+        exit(0);
+    }
+#endif
+    s_running = false;
+    vTaskDelete(NULL);
+}
+
+static bool bench_spawn(TaskFunction_t fn, void *arg)
+{
+    if (!s_have_target || s_running) {
+        return false;
+    }
+    if (s_frame_sem == NULL) {
+        s_frame_sem = xSemaphoreCreateBinary();
+        if (s_frame_sem == NULL) return false;
+    }
+    s_running = true;
+    if (xTaskCreate(fn, "ui_bench", BENCH_TASK_STACK, arg, BENCH_TASK_PRIO, NULL) != pdPASS) {
+        s_running = false;
+        return false;
+    }
+    return true;
+}
+
+bool ui_bench_start(void)
+{
+    return bench_spawn(bench_task, NULL);
+}
+
+void ui_bench_init(const ui_bench_target_t *target)
+{
+    s_target = *target;
+    s_have_target = true;
+#if CONFIG_IDF_TARGET_LINUX
+    const char *check = getenv("T1_CHECK");
+    if (check && check[0]) {
+        bench_spawn(check_task, (void *)check);
+        return;
+    }
+    s_out_path = getenv("T1_BENCH");
+    if (s_out_path && s_out_path[0]) {
+        ui_bench_start();
+    } else {
+        s_out_path = NULL;
+    }
+#endif
+}
+
+#if CONFIG_APP_CONSOLE
+static int bench_cmd(int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+    if (!ui_bench_start()) {
+        printf("bench already running\n");
+        return 1;
+    }
+    printf("running %u scenarios, JSON report follows\n", (unsigned)(sizeof(s_scenarios) / sizeof(s_scenarios[0])));
+    return 0;
+}
+#endif
+
+void ui_bench_register_cmd(void)
+{
+#if CONFIG_APP_CONSOLE
+    const esp_console_cmd_t cmd = {
+        .command = "bench",
+        .help = "Run render scenarios (idle, arc_drag, full_redraw, state_flip) and print a JSON report",
+        .hint = NULL,
+        .func = &bench_cmd,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&cmd));
+#endif
+}
+
+#endif /* CONFIG_UI_BENCH */
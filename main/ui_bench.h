@@ -0,0 +1,62 @@
+/**
+ * @file ui_bench.h
+ * @brief Сценарии замера рендера экрана термостата, отчёт JSON
+ *
+ * Сценарии идут по настоящему дереву виджетов main.c:
+ *   idle        3 с с таймером room_temp_timer_cb (300 мс)
+ *   arc_drag    уставка 15.0 -> 30.0 °C по шагу 0.1, как при протяжке арки
+ *   full_redraw инвалидация всего экрана
+ *   state_flip  HEATING -> COOLING -> HOLD по кругу
+ * На каждый кадр — время рендера (RENDER_START..RENDER_READY), площадь
+ * перерисовки и число задач рисования; по сценарию — среднее, p99 и
+ * максимум, плюс куча LVGL. Числа одного сценария сравнимы между
+ * коммитами при одной цели и одном режиме рендера (они есть в отчёте).
+ *
+ * Запуск: команда консоли «bench», в сборке под Linux — переменная
+ * T1_BENCH=<файл.json> (или «-» — в stdout): прогон сразу после старта UI
+ * и выход. tools/bench_compare.py сравнивает два отчёта.
+ *
+ * Проверка под Linux: T1_CHECK=<файл эталонов> проходит короткие шаги по UI
+ * и на каждом сверяет площадь перерисовки с суммой областей виджетов,
+ * которые шаг вправе изменить (шаг без изменений — ноль), а хеш кадра — с
+ * эталоном. Код выхода 1 при расхождении. T1_CHECK_RECORD=1 записывает
+ * эталоны заново — после намеренной правки вида.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sdkconfig.h"
+#include "lvgl.h"
+
+/* Что сценарии трогают в UI main.c */
+typedef struct {
+    lv_obj_t *arc;              /* значение и LV_EVENT_VALUE_CHANGED — как от касания */
+    lv_obj_t *label_set;        /* подписи: границы перерисовки в проверке */
+    lv_obj_t *label_room;
+    lv_obj_t *label_state;
+    lv_timer_t *room_timer;     /* на время прочих сценариев на паузе */
+    /* Уставка и комнатная температура в десятых °C, с обновлением подписей;
+     * вызывается под display_lock() */
+    void (*set_temps)(int32_t setpoint, int32_t room);
+} ui_bench_target_t;
+
+#if CONFIG_UI_BENCH
+
+/* После построения UI; на хосте с T1_CHECK или T1_BENCH сразу запускает прогон */
+void ui_bench_init(const ui_bench_target_t *target);
+
+/* Прогон в отдельной задаче; false — уже идёт */
+bool ui_bench_start(void);
+
+/* Команда консоли «bench» */
+void ui_bench_register_cmd(void);
+
+#else
+
+static inline void ui_bench_init(const ui_bench_target_t *target) { (void)target; }
+static inline bool ui_bench_start(void) { return false; }
+static inline void ui_bench_register_cmd(void) {}
+
+#endif
@@ -0,0 +1,29 @@
+/**
+ * @file ui_palette.h
+ * @brief Цвета экрана термостата
+ *
+ * Единый список цветов UI: main.c берёт их отсюда, а в режиме 8-битного
+ * фрейм-буфера из этого же списка строится палитра (см. fb_palette.h),
+ * поэтому цвета UI выводятся без искажений.
+ */
+
+#pragma once
+
+#define UI_COLOR_BG         0x0d1b2a    /* фон экрана, первым: к нему смешиваются остальные */
+#define UI_COLOR_TRACK      0x1e293b    /* дорожка арки и ручка */
+#define UI_COLOR_HOLD       0x4ade80    /* индикатор арки, состояние HOLD */
+#define UI_COLOR_HEAT       0xff7a3d
+#define UI_COLOR_COOL       0x00d1ff    /* также заголовок */
+#define UI_COLOR_TEXT       0xffffff
+#define UI_COLOR_MUTED      0x94a3b8    /* температура в комнате */
+#define UI_COLOR_FOOTER     0x64748b
+
+#define UI_PALETTE_COLORS(X) \
+    X(UI_COLOR_BG)      \
+    X(UI_COLOR_TRACK)   \
+    X(UI_COLOR_HOLD)    \
+    X(UI_COLOR_HEAT)    \
+    X(UI_COLOR_COOL)    \
+    X(UI_COLOR_TEXT)    \
+    X(UI_COLOR_MUTED)   \
+    X(UI_COLOR_FOOTER)
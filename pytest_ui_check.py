@@ -0,0 +1,67 @@
+'''
+Проверка перерисовки UI на сборке под Linux (ui_bench.h, T1_CHECK).
+
+    idf.py --preview set-target linux && idf.py build
+    pytest pytest_ui_check.py                 # сверить с test/golden
+    pytest pytest_ui_check.py --ui-record     # записать эталоны заново
+
+Эталоны хешей кадров — по одному файлу на режим рендера:
+test/golden/ui_check_<режим>.txt. Без сборки под Linux тест пропускается,
+без эталона для режима сборки — падает с подсказкой, как его записать.
+'''
+
+import os
+import re
+import subprocess
+from pathlib import Path
+
+import pytest
+
+ROOT = Path(__file__).resolve().parent
+GOLDEN_DIR = ROOT / 'test' / 'golden'
+RUN_TIMEOUT_S = 60
+
+
+def build_dir():
+    return Path(os.environ.get('T1_BUILD_DIR', ROOT / 'build'))
+
+
+def render_mode(sdkconfig_h):
+    text = sdkconfig_h.read_text()
+    for mode in ('direct', 'partial', 'full'):
+        if re.search(r'#define CONFIG_DISPLAY_RENDER_MODE_%s 1' % mode.upper(), text):
+            return mode
+    return 'full'
+
+
+def test_ui_check(request):
+    build = build_dir()
+    elf = build / 'Terminal1.elf'
+    sdkconfig_h = build / 'config' / 'sdkconfig.h'
+    if not elf.exists() or not sdkconfig_h.exists():
+        pytest.skip('no host build in %s: idf.py --preview set-target linux && idf.py build' % build)
+    if '#define CONFIG_IDF_TARGET_LINUX 1' not in sdkconfig_h.read_text():
+        pytest.skip('%s is not a linux target build' % build)
+
+    mode = render_mode(sdkconfig_h)
+    golden = GOLDEN_DIR / ('ui_check_%s.txt' % mode)
+    record = request.config.getoption('--ui-record')
+    if not record and not golden.exists():
+        pytest.fail('no golden hashes for render mode %s: run pytest %s --ui-record and commit %s '
+                    '(test/golden/README.md)' % (mode, Path(__file__).name, golden.relative_to(ROOT)))
+
+    if not record:
+        # Заголовок пишет ui_bench: эталон другого режима сверять бессмысленно
+        header = golden.read_text().splitlines()[0]
+        assert 'render_mode %s,' % mode in header, '%s: %s' % (golden.name, header)
+
+    env = dict(os.environ, T1_CHECK=str(golden))
+    if record:
+        env['T1_CHECK_RECORD'] = '1'
+    else:
+        env.pop('T1_CHECK_RECORD', None)
+    proc = subprocess.run([str(elf)], env=env, cwd=str(build), stdout=subprocess.PIPE,
+                          stderr=subprocess.STDOUT, timeout=RUN_TIMEOUT_S, universal_newlines=True)
+    steps = [line for line in proc.stdout.splitlines() if line.startswith('CHECK ')]
+    print('\n'.join(steps))
+    assert proc.returncode == 0 and 'CHECK PASSED' in steps, proc.stdout[-4000:]
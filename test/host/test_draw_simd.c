@@ -0,0 +1,235 @@
+/**
+ * @file test_draw_simd.c
+ * @brief draw_simd: сравнение с эталонными циклами LVGL бит в бит
+ *
+ * Эталон — формулы lv_draw_sw_blend_to_rgb565.c: lv_color_16_16_mix() на
+ * упакованном слове и LV_OPA_MIX2() для маски с opa. draw_simd.c на хосте
+ * идёт через модель PIE-циклов, поэтому проверяются и раскладка строки
+ * (голова, блоки, хвост), и арифметика по дорожкам. Ширины нечётные и
+ * кратные блоку, адреса и strides сдвинуты на любое число пикселей.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "draw_simd.h"
+#include "test_util.h"
+
+#define BUF_PX      (8 * 1024)
+#define ROWS        3
+
+/* Копия lv_color_16_16_mix() из LVGL 9 */
+static uint16_t lv_mix_ref(uint16_t c1, uint16_t c2, uint8_t mix)
+{
+    if (mix == 255) return c1;
+    if (mix == 0) return c2;
+    if (c1 == c2) return c1;
+    uint32_t m = ((uint32_t)mix + 4) >> 3;
+    uint32_t bg = (uint32_t)(c2 | ((uint32_t)c2 << 16)) & 0x7E0F81F;
+    uint32_t fg = (uint32_t)(c1 | ((uint32_t)c1 << 16)) & 0x7E0F81F;
+    uint32_t result = ((((fg - bg) * m) >> 5) + bg) & 0x7E0F81F;
+    return (uint16_t)((result >> 16) | result);
+}
+
+static uint8_t mix_ref(const uint8_t *mask, int32_t x, uint8_t opa)
+{
+    if (!mask) return opa;
+    if (opa == DRAW_SIMD_OPA_COVER) return mask[x];
+    return (uint8_t)(((int32_t)mask[x] * opa) >> 8);   /* LV_OPA_MIX2 */
+}
+
+static uint16_t s_dst[BUF_PX] __attribute__((aligned(16)));
+static uint16_t s_ref[BUF_PX] __attribute__((aligned(16)));
+static uint16_t s_src[BUF_PX] __attribute__((aligned(16)));
+static uint8_t s_mask[BUF_PX] __attribute__((aligned(16)));
+
+static uint32_t s_rng = 12345;
+
+static uint32_t rnd(void)
+{
+    s_rng = s_rng * 1664525u + 1013904223u;
+    return s_rng >> 8;
+}
+
+static void fill_random(void)
+{
+    for (int i = 0; i < BUF_PX; i++) {
+        s_dst[i] = (uint16_t)rnd();
+        s_src[i] = (uint16_t)rnd();
+        /* Маска сглаживания: много 0 и 255, остальное между */
+        uint32_t r = rnd() % 4;
+        s_mask[i] = r == 0 ? 0 : r == 1 ? 255 : (uint8_t)rnd();
+    }
+    memcpy(s_ref, s_dst, sizeof(s_ref));
+}
+
+static const int32_t s_widths[] = { 1, 7, 8, 9, 31, 32, 33, 47, 63, 64, 65, 100, 129, 480 };
+static const int32_t s_opas[] = { 1, 7, 64, 127, 128, 200, 252 };
+
+/* Сдвиг начала (в пикселях) и «хвост» stride — оба нечётные и чётные */
+#define OFFS_MAX    8
+#define PAD_MAX     3
+
+static int s_cases;
+
+typedef enum {
+    OP_FILL,
+    OP_COPY,
+    OP_FILL_MIX,
+    OP_BLEND,
+} op_t;
+
+static void run_case(op_t op, int32_t w, int dst_off, int src_off, int pad, bool use_mask, uint8_t opa)
+{
+    int32_t dst_stride = (w + pad) * 2;
+    int32_t src_stride = (w + pad + 1) * 2;
+    int32_t mask_stride = w + pad + 3;
+    uint16_t *dst = s_dst + dst_off;
+    uint16_t *ref = s_ref + dst_off;
+    const uint16_t *src = s_src + src_off;
+    const uint8_t *mask = use_mask ? s_mask + src_off : NULL;
+    uint16_t color = (uint16_t)rnd();
+
+    fill_random();
+    switch (op) {
+    case OP_FILL:
+        draw_simd_fill16(dst, w, ROWS, dst_stride, color);
+        break;
+    case OP_COPY:
+        draw_simd_copy16(dst, dst_stride, src, src_stride, w, ROWS);
+        break;
+    case OP_FILL_MIX:
+        draw_simd_fill16_mix(dst, w, ROWS, dst_stride, color, mask, mask_stride, opa);
+        break;
+    case OP_BLEND:
+        draw_simd_blend16(dst, dst_stride, src, src_stride, w, ROWS, mask, mask_stride, opa);
+        break;
+    }
+
+    for (int32_t y = 0; y < ROWS; y++) {
+        uint16_t *r = ref + y * dst_stride / 2;
+        const uint16_t *s = src + y * src_stride / 2;
+        const uint8_t *m = mask ? mask + y * mask_stride : NULL;
+        for (int32_t x = 0; x < w; x++) {
+            switch (op) {
+            case OP_FILL:
+                r[x] = color;
+                break;
+            case OP_COPY:
+                r[x] = s[x];
+                break;
+            case OP_FILL_MIX:
+                r[x] = lv_mix_ref(color, r[x], mix_ref(m, x, opa));
+                break;
+            case OP_BLEND:
+                r[x] = lv_mix_ref(s[x], r[x], mix_ref(m, x, opa));
+                break;
+            }
+        }
+    }
+    s_cases++;
+    if (memcmp(s_dst, s_ref, sizeof(s_dst)) != 0) {
+        for (int i = 0; i < BUF_PX; i++) {
+            if (s_dst[i] != s_ref[i]) {
+                fprintf(stderr, "op %d w %d dst_off %d src_off %d pad %d mask %d opa %d: px %d got %04x want %04x\n",
+                        (int)op, (int)w, dst_off, src_off, pad, (int)use_mask, opa, i, s_dst[i], s_ref[i]);
+                break;
+            }
+        }
+        CHECK(false);
+    }
+}
+
+static void sweep(op_t op, bool use_mask, uint8_t opa)
+{
+    for (size_t wi = 0; wi < sizeof(s_widths) / sizeof(s_widths[0]); wi++) {
+        for (int doff = 0; doff < OFFS_MAX; doff++) {
+            for (int pad = 0; pad <= PAD_MAX; pad++) {
+                /* Источник с тем же выравниванием (блочный путь) и с другим (C) */
+                run_case(op, s_widths[wi], doff, doff, pad, use_mask, opa);
+                run_case(op, s_widths[wi], doff, (doff + 3) % OFFS_MAX, pad, use_mask, opa);
+            }
+        }
+    }
+}
+
+static void test_fill(void)
+{
+    sweep(OP_FILL, false, 0);
+}
+
+static void test_copy(void)
+{
+    sweep(OP_COPY, false, 0);
+}
+
+static void test_fill_opa(void)
+{
+    for (size_t i = 0; i < sizeof(s_opas) / sizeof(s_opas[0]); i++) {
+        sweep(OP_FILL_MIX, false, (uint8_t)s_opas[i]);
+    }
+}
+
+static void test_fill_mask(void)
+{
+    sweep(OP_FILL_MIX, true, DRAW_SIMD_OPA_COVER);
+}
+
+static void test_fill_mask_opa(void)
+{
+    for (size_t i = 0; i < sizeof(s_opas) / sizeof(s_opas[0]); i++) {
+        sweep(OP_FILL_MIX, true, (uint8_t)s_opas[i]);
+    }
+}
+
+static void test_blend_opa(void)
+{
+    for (size_t i = 0; i < sizeof(s_opas) / sizeof(s_opas[0]); i++) {
+        sweep(OP_BLEND, false, (uint8_t)s_opas[i]);
+    }
+}
+
+static void test_blend_mask(void)
+{
+    sweep(OP_BLEND, true, DRAW_SIMD_OPA_COVER);
+}
+
+static void test_blend_mask_opa(void)
+{
+    for (size_t i = 0; i < sizeof(s_opas) / sizeof(s_opas[0]); i++) {
+        sweep(OP_BLEND, true, (uint8_t)s_opas[i]);
+    }
+}
+
+/* Все доли на крайних и случайных цветах, полная строка блоков */
+static void test_mix_all_opa(void)
+{
+    static const uint16_t edge[] = { 0x0000, 0xFFFF, 0xF800, 0x07E0, 0x001F, 0x0820, 0x8410, 0x7BEF };
+    for (int opa = 0; opa < 256; opa++) {
+        for (int i = 0; i < 64; i++) {
+            uint16_t fg = i < 8 ? edge[i] : (uint16_t)rnd();
+            for (int x = 0; x < 64; x++) {
+                s_dst[x] = x < 8 ? edge[x] : (uint16_t)rnd();
+                s_ref[x] = lv_mix_ref(fg, s_dst[x], (uint8_t)opa);
+            }
+            draw_simd_fill16_mix(s_dst, 64, 1, 64 * 2, fg, NULL, 0, (uint8_t)opa);
+            CHECK(memcmp(s_dst, s_ref, 64 * sizeof(uint16_t)) == 0);
+        }
+    }
+}
+
+int main(void)
+{
+    RUN(test_fill);
+    RUN(test_copy);
+    RUN(test_fill_opa);
+    RUN(test_fill_mask);
+    RUN(test_fill_mask_opa);
+    RUN(test_blend_opa);
+    RUN(test_blend_mask);
+    RUN(test_blend_mask_opa);
+    RUN(test_mix_all_opa);
+    printf("%d cases\n", s_cases);
+    return TEST_EXIT();
+}
@@ -0,0 +1,297 @@
+/**
+ * @file test_fb_copy.c
+ * @brief fb_copy: раскладка области на сегменты и прогон через движок
+ *
+ * Движок-заглушка повторяет поведение GDMA: держит сегмент «в полёте»,
+ * пока тест не завершит его, и проверяет, что сегмент в полёте один.
+ * Результат сравнивается с попиксельным копированием области.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "fb_copy.h"
+#include "test_util.h"
+
+#define SCR_W       40
+#define SCR_H       24
+#define SEG_MAX     256
+
+typedef enum {
+    MOCK_SYNC,      /* копирует сразу, FB_COPY_DONE */
+    MOCK_ASYNC,     /* FB_COPY_PENDING, копирует в mock_complete() */
+    MOCK_ERROR,     /* FB_COPY_ERROR: job копирует сам */
+} mock_mode_t;
+
+typedef struct {
+    mock_mode_t mode;
+    fb_copy_seg_t segs[SEG_MAX];
+    size_t seg_cnt;
+    size_t prepared;
+    bool prepare_after_start;
+    fb_copy_job_t *inflight_job;
+    fb_copy_seg_t inflight;
+    int inflight_cnt;
+    int max_inflight;
+} mock_engine_t;
+
+static fb_copy_status_t mock_start(void *ctx, const fb_copy_seg_t *seg, fb_copy_job_t *job)
+{
+    mock_engine_t *m = ctx;
+    if (m->seg_cnt < SEG_MAX) {
+        m->segs[m->seg_cnt] = *seg;
+    }
+    m->seg_cnt++;
+    switch (m->mode) {
+    case MOCK_SYNC:
+        memcpy(seg->dst, seg->src, seg->len);
+        return FB_COPY_DONE;
+    case MOCK_ERROR:
+        return FB_COPY_ERROR;
+    case MOCK_ASYNC:
+    default:
+        m->inflight = *seg;
+        m->inflight_job = job;
+        m->inflight_cnt++;
+        if (m->inflight_cnt > m->max_inflight) {
+            m->max_inflight = m->inflight_cnt;
+        }
+        return FB_COPY_PENDING;
+    }
+}
+
+static void mock_prepare(void *ctx, const fb_copy_seg_t *seg)
+{
+    mock_engine_t *m = ctx;
+    (void)seg;
+    if (m->seg_cnt) {
+        m->prepare_after_start = true;
+    }
+    m->prepared++;
+}
+
+/* «Прерывание» завершения: копирует сегмент в полёте и продолжает job */
+static bool mock_complete(mock_engine_t *m)
+{
+    if (!m->inflight_job) {
+        return false;
+    }
+    fb_copy_job_t *job = m->inflight_job;
+    memcpy(m->inflight.dst, m->inflight.src, m->inflight.len);
+    m->inflight_job = NULL;
+    m->inflight_cnt--;
+    fb_copy_job_seg_done(job);
+    return true;
+}
+
+static int s_done_calls;
+
+static void done_cb(void *arg)
+{
+    (void)arg;
+    s_done_calls++;
+}
+
+typedef struct {
+    uint8_t fb[SCR_H * (SCR_W * 4 + 12)];
+    uint8_t ref[SCR_H * (SCR_W * 4 + 12)];
+    uint8_t src[SCR_H * (SCR_W * 4 + 12)];
+    mock_engine_t mock;
+    fb_copy_engine_t engine;
+    fb_copy_job_t job;
+} fixture_t;
+
+static fixture_t s_fx;
+
+/* Источник: пиксели области подряд с шагом src_stride, в каждом байте
+ * его позиция, чтобы перестановки были видны */
+static void fixture_setup(mock_mode_t mode, const fb_rect_t *area, size_t src_stride, size_t fb_stride,
+                          uint8_t px_size, const fb_rect_t *rects, size_t rect_cnt)
+{
+    memset(&s_fx, 0, sizeof(s_fx));
+    for (size_t i = 0; i < sizeof(s_fx.src); i++) {
+        s_fx.src[i] = (uint8_t)(i * 7 + 3);
+    }
+    memset(s_fx.fb, 0xEE, sizeof(s_fx.fb));
+    memset(s_fx.ref, 0xEE, sizeof(s_fx.ref));
+    for (size_t r = 0; r < rect_cnt; r++) {
+        for (int32_t y = rects[r].y1; y <= rects[r].y2; y++) {
+            for (int32_t x = rects[r].x1; x <= rects[r].x2; x++) {
+                memcpy(&s_fx.ref[(size_t)y * fb_stride + (size_t)x * px_size],
+                       &s_fx.src[(size_t)(y - area->y1) * src_stride + (size_t)(x - area->x1) * px_size],
+                       px_size);
+            }
+        }
+    }
+
+    s_fx.mock.mode = mode;
+    s_fx.engine.start = mock_start;
+    s_fx.engine.prepare = mock_prepare;
+    s_fx.engine.ctx = &s_fx.mock;
+
+    s_fx.job.src = s_fx.src;
+    s_fx.job.src_stride = src_stride;
+    s_fx.job.area = *area;
+    s_fx.job.fb = s_fx.fb;
+    s_fx.job.fb_stride = fb_stride;
+    s_fx.job.px_size = px_size;
+    s_fx.job.rects = rects;
+    s_fx.job.rect_cnt = rect_cnt;
+    s_fx.job.engine = &s_fx.engine;
+    s_fx.job.done_cb = done_cb;
+    s_done_calls = 0;
+}
+
+static void run_to_end(void)
+{
+    fb_copy_job_start(&s_fx.job);
+    int guard = SEG_MAX;
+    while (mock_complete(&s_fx.mock) && --guard) {
+    }
+}
+
+/* Полная ширина и у источника, и у фрейм-буфера: один сегмент на прямоугольник */
+static void test_full_width_single_segment(void)
+{
+    fb_rect_t area = { 0, 4, SCR_W - 1, 11 };
+    fixture_setup(MOCK_ASYNC, &area, SCR_W * 2, SCR_W * 2, 2, &area, 1);
+    run_to_end();
+    CHECK_EQ(s_fx.mock.seg_cnt, 1);
+    CHECK_EQ(s_fx.mock.segs[0].len, 8 * SCR_W * 2);
+    CHECK(s_fx.mock.segs[0].dst == s_fx.fb + 4 * SCR_W * 2);
+    CHECK(memcmp(s_fx.fb, s_fx.ref, sizeof(s_fx.fb)) == 0);
+    CHECK_EQ(s_done_calls, 1);
+}
+
+/* Узкая область: строка на сегмент, шаг источника — ширина области */
+static void test_narrow_area_row_segments(void)
+{
+    fb_rect_t area = { 5, 2, 17, 9 };
+    fixture_setup(MOCK_ASYNC, &area, 13 * 2, SCR_W * 2, 2, &area, 1);
+    run_to_end();
+    CHECK_EQ(s_fx.mock.seg_cnt, 8);
+    for (size_t i = 0; i < s_fx.mock.seg_cnt; i++) {
+        CHECK_EQ(s_fx.mock.segs[i].len, 13 * 2);
+        CHECK(s_fx.mock.segs[i].dst == s_fx.fb + (2 + i) * SCR_W * 2 + 5 * 2);
+        CHECK(s_fx.mock.segs[i].src == s_fx.src + i * 13 * 2);
+    }
+    CHECK(memcmp(s_fx.fb, s_fx.ref, sizeof(s_fx.fb)) == 0);
+    CHECK_EQ(s_fx.mock.max_inflight, 1);
+    CHECK_EQ(s_done_calls, 1);
+}
+
+/* Фрейм-буфер с «хвостом» строки: полноширинная область не склеивается */
+static void test_padded_fb_stride(void)
+{
+    fb_rect_t area = { 0, 0, SCR_W - 1, 5 };
+    size_t fb_stride = SCR_W * 2 + 12;
+    fixture_setup(MOCK_SYNC, &area, SCR_W * 2, fb_stride, 2, &area, 1);
+    run_to_end();
+    CHECK_EQ(s_fx.mock.seg_cnt, 6);
+    CHECK(memcmp(s_fx.fb, s_fx.ref, sizeof(s_fx.fb)) == 0);
+    CHECK_EQ(s_done_calls, 1);
+}
+
+/* Источник с отступом в конце строки (stride больше ширины области) */
+static void test_padded_src_stride(void)
+{
+    fb_rect_t area = { 0, 3, SCR_W - 1, 6 };
+    fixture_setup(MOCK_ASYNC, &area, SCR_W * 2 + 6, SCR_W * 2, 2, &area, 1);
+    run_to_end();
+    CHECK_EQ(s_fx.mock.seg_cnt, 4);
+    CHECK(memcmp(s_fx.fb, s_fx.ref, sizeof(s_fx.fb)) == 0);
+}
+
+/* Несколько подпрямоугольников области (оставшиеся после отбрасывания тайлов) */
+static void test_sub_rects(void)
+{
+    static const fb_rect_t rects[] = {
+        { 0, 0, SCR_W - 1, 1 },     /* полная ширина: одним куском */
+        { 8, 4, 15, 6 },
+        { 30, 4, 39, 4 },
+        { 1, 10, 1, 12 },           /* один пиксель в ширину */
+    };
+    fb_rect_t area = { 0, 0, SCR_W - 1, 15 };
+    fixture_setup(MOCK_ASYNC, &area, SCR_W * 2, SCR_W * 2, 2, rects, 4);
+    run_to_end();
+    CHECK_EQ(s_fx.mock.seg_cnt, 1 + 3 + 1 + 3);
+    CHECK(memcmp(s_fx.fb, s_fx.ref, sizeof(s_fx.fb)) == 0);
+    CHECK_EQ(s_fx.mock.max_inflight, 1);
+    CHECK_EQ(s_done_calls, 1);
+}
+
+/* Область со смещением по x и y, нечётный размер пикселя */
+static void test_offset_area_px3(void)
+{
+    static const fb_rect_t rects[] = { { 12, 9, 20, 14 }, { 25, 9, 26, 10 } };
+    fb_rect_t area = { 11, 8, 27, 15 };
+    size_t src_stride = (size_t)(27 - 11 + 1) * 3;
+    fixture_setup(MOCK_SYNC, &area, src_stride, SCR_W * 3, 3, rects, 2);
+    run_to_end();
+    CHECK_EQ(s_fx.mock.seg_cnt, 6 + 2);
+    CHECK(memcmp(s_fx.fb, s_fx.ref, sizeof(s_fx.fb)) == 0);
+    CHECK_EQ(s_done_calls, 1);
+}
+
+/* Движок не принял сегмент: job копирует его сам и идёт дальше */
+static void test_engine_error_fallback(void)
+{
+    fb_rect_t area = { 3, 0, 9, 4 };
+    fixture_setup(MOCK_ERROR, &area, 7 * 2, SCR_W * 2, 2, &area, 1);
+    run_to_end();
+    CHECK_EQ(s_fx.mock.seg_cnt, 5);
+    CHECK(memcmp(s_fx.fb, s_fx.ref, sizeof(s_fx.fb)) == 0);
+    CHECK_EQ(s_done_calls, 1);
+}
+
+/* prepare() видит все сегменты до первого start() */
+static void test_prepare_before_start(void)
+{
+    fb_rect_t area = { 0, 0, 9, 7 };
+    fixture_setup(MOCK_ASYNC, &area, 10 * 2, SCR_W * 2, 2, &area, 1);
+    fb_copy_job_start(&s_fx.job);
+    CHECK_EQ(s_fx.mock.prepared, 8);
+    CHECK_EQ(s_fx.mock.seg_cnt, 1);
+    CHECK(!s_fx.mock.prepare_after_start);
+    while (mock_complete(&s_fx.mock)) {
+    }
+    CHECK_EQ(s_fx.mock.prepared, 8);
+    CHECK_EQ(s_fx.mock.seg_cnt, 8);
+    CHECK(memcmp(s_fx.fb, s_fx.ref, sizeof(s_fx.fb)) == 0);
+}
+
+/* Пустое задание: done_cb сразу, движок не вызывается */
+static void test_empty_job(void)
+{
+    fb_rect_t area = { 0, 0, 9, 9 };
+    fixture_setup(MOCK_ASYNC, &area, 10 * 2, SCR_W * 2, 2, NULL, 0);
+    fb_copy_job_start(&s_fx.job);
+    CHECK_EQ(s_fx.mock.seg_cnt, 0);
+    CHECK_EQ(s_done_calls, 1);
+}
+
+/* Движок memcpy из fb_copy.c даёт тот же результат */
+static void test_memcpy_engine(void)
+{
+    static const fb_rect_t rects[] = { { 2, 1, 6, 3 }, { 0, 5, SCR_W - 1, 7 } };
+    fb_rect_t area = { 0, 1, SCR_W - 1, 7 };
+    fixture_setup(MOCK_SYNC, &area, SCR_W * 2, SCR_W * 2, 2, rects, 2);
+    s_fx.job.engine = &fb_copy_engine_memcpy;
+    fb_copy_job_start(&s_fx.job);
+    CHECK(memcmp(s_fx.fb, s_fx.ref, sizeof(s_fx.fb)) == 0);
+    CHECK_EQ(s_done_calls, 1);
+}
+
+int main(void)
+{
+    RUN(test_full_width_single_segment);
+    RUN(test_narrow_area_row_segments);
+    RUN(test_padded_fb_stride);
+    RUN(test_padded_src_stride);
+    RUN(test_sub_rects);
+    RUN(test_offset_area_px3);
+    RUN(test_engine_error_fallback);
+    RUN(test_prepare_before_start);
+    RUN(test_empty_job);
+    RUN(test_memcpy_engine);
+    return TEST_EXIT();
+}
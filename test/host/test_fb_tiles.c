@@ -0,0 +1,230 @@
+/**
+ * @file test_fb_tiles.c
+ * @brief fb_tiles: пропуск неизменённых тайлов и склейка в прямоугольники
+ *
+ * Кадр рисуется в «экран», из области вырезается буфер, как у LVGL, и
+ * прогоняется через fb_tiles_filter(); прямоугольники копируются во
+ * фрейм-буфер. Кроме точного набора прямоугольников в простых случаях
+ * проверяется главное: после записи фрейм-буфер совпадает с кадром.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "fb_tiles.h"
+#include "test_util.h"
+
+#define T           FB_TILE_SIZE
+#define SCR_W       (4 * T)
+#define SCR_H       (3 * T)
+#define PX          2
+#define RECTS_MAX   16
+
+static uint16_t s_frame[SCR_H][SCR_W];  /* что нарисовал LVGL */
+static uint16_t s_fb[SCR_H][SCR_W];     /* что дошло до панели */
+static uint16_t s_src[SCR_H * SCR_W];   /* буфер области, stride = ширина области */
+static uint32_t s_hash[FB_TILES_COUNT(SCR_W, SCR_H)];
+static fb_tiles_t s_tiles;
+static fb_rect_t s_out[RECTS_MAX];
+
+static uint32_t s_rng = 7;
+
+static uint32_t rnd(void)
+{
+    s_rng = s_rng * 1664525u + 1013904223u;
+    return s_rng >> 8;
+}
+
+static void reset(void)
+{
+    for (int y = 0; y < SCR_H; y++) {
+        for (int x = 0; x < SCR_W; x++) {
+            s_frame[y][x] = (uint16_t)(x * 7 + y * 131);
+        }
+    }
+    memset(s_fb, 0, sizeof(s_fb));
+    fb_tiles_init(&s_tiles, s_hash, SCR_W, SCR_H, PX);
+}
+
+/* Отрисовать area и записать изменившееся во фрейм-буфер */
+static size_t flush(fb_rect_t area, size_t out_max)
+{
+    int32_t w = area.x2 - area.x1 + 1;
+    for (int32_t y = area.y1; y <= area.y2; y++) {
+        memcpy(&s_src[(y - area.y1) * w], &s_frame[y][area.x1], (size_t)w * PX);
+    }
+    size_t n = fb_tiles_filter(&s_tiles, (const uint8_t *)s_src, (size_t)w * PX, &area, s_out, out_max);
+    for (size_t i = 0; i < n; i++) {
+        const fb_rect_t *r = &s_out[i];
+        CHECK(r->x1 >= area.x1 && r->x2 <= area.x2 && r->y1 >= area.y1 && r->y2 <= area.y2);
+        for (int32_t y = r->y1; y <= r->y2; y++) {
+            memcpy(&s_fb[y][r->x1], &s_src[(y - area.y1) * w + (r->x1 - area.x1)], (size_t)(r->x2 - r->x1 + 1) * PX);
+        }
+    }
+    return n;
+}
+
+static bool fb_matches(fb_rect_t area)
+{
+    for (int32_t y = area.y1; y <= area.y2; y++) {
+        if (memcmp(&s_fb[y][area.x1], &s_frame[y][area.x1], (size_t)(area.x2 - area.x1 + 1) * PX) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void touch_tile(int tx, int ty)
+{
+    s_frame[ty * T + 3][tx * T + 5] ^= 0x5A5A;
+}
+
+static bool rect_eq(const fb_rect_t *r, int32_t x1, int32_t y1, int32_t x2, int32_t y2)
+{
+    return r->x1 == x1 && r->y1 == y1 && r->x2 == x2 && r->y2 == y2;
+}
+
+static const fb_rect_t s_screen = { 0, 0, SCR_W - 1, SCR_H - 1 };
+
+/* Первый кадр: хэши неизвестны, вся область одним прямоугольником */
+static void test_first_flush_writes_all(void)
+{
+    reset();
+    CHECK_EQ(flush(s_screen, RECTS_MAX), 1);
+    CHECK(rect_eq(&s_out[0], 0, 0, SCR_W - 1, SCR_H - 1));
+    CHECK_EQ(s_tiles.written, 12);
+    CHECK_EQ(s_tiles.skipped, 0);
+    CHECK(fb_matches(s_screen));
+}
+
+static void test_unchanged_skipped(void)
+{
+    reset();
+    flush(s_screen, RECTS_MAX);
+    CHECK_EQ(flush(s_screen, RECTS_MAX), 0);
+    CHECK_EQ(s_tiles.skipped, 12);
+}
+
+static void test_single_tile(void)
+{
+    reset();
+    flush(s_screen, RECTS_MAX);
+    touch_tile(2, 1);
+    CHECK_EQ(flush(s_screen, RECTS_MAX), 1);
+    CHECK(rect_eq(&s_out[0], 2 * T, T, 3 * T - 1, 2 * T - 1));
+    CHECK(fb_matches(s_screen));
+}
+
+/* Соседние по строке тайлы — одна полоса; тот же столбец ниже — удлиняет её */
+static void test_runs_merge(void)
+{
+    reset();
+    flush(s_screen, RECTS_MAX);
+    touch_tile(1, 0);
+    touch_tile(2, 0);
+    touch_tile(1, 1);
+    touch_tile(2, 1);
+    CHECK_EQ(flush(s_screen, RECTS_MAX), 1);
+    CHECK(rect_eq(&s_out[0], T, 0, 3 * T - 1, 2 * T - 1));
+    CHECK(fb_matches(s_screen));
+}
+
+/* Г-образное изменение: полосы с разными x не склеиваются */
+static void test_l_shape(void)
+{
+    reset();
+    flush(s_screen, RECTS_MAX);
+    touch_tile(0, 0);
+    touch_tile(1, 0);
+    touch_tile(0, 1);
+    CHECK_EQ(flush(s_screen, RECTS_MAX), 2);
+    CHECK(rect_eq(&s_out[0], 0, 0, 2 * T - 1, T - 1));
+    CHECK(rect_eq(&s_out[1], 0, T, T - 1, 2 * T - 1));
+    CHECK(fb_matches(s_screen));
+}
+
+/* Частично покрытый тайл пишется всегда и забывает хэш: следующий полный
+ * проход запишет его снова, даже если пиксели не менялись */
+static void test_partial_tile(void)
+{
+    reset();
+    flush(s_screen, RECTS_MAX);
+    fb_rect_t part = { T + 4, 4, 2 * T - 5, T - 5 };
+    CHECK_EQ(flush(part, RECTS_MAX), 1);
+    CHECK(rect_eq(&s_out[0], part.x1, part.y1, part.x2, part.y2));
+    CHECK_EQ(flush(s_screen, RECTS_MAX), 1);
+    CHECK(rect_eq(&s_out[0], T, 0, 2 * T - 1, T - 1));
+}
+
+/* Не хватило out: вся область одним прямоугольником, хэши уже обновлены */
+static void test_overflow_whole_area(void)
+{
+    reset();
+    flush(s_screen, RECTS_MAX);
+    touch_tile(0, 0);
+    touch_tile(2, 0);
+    touch_tile(1, 2);
+    CHECK_EQ(flush(s_screen, 2), 1);
+    CHECK(rect_eq(&s_out[0], 0, 0, SCR_W - 1, SCR_H - 1));
+    CHECK(fb_matches(s_screen));
+    CHECK_EQ(flush(s_screen, RECTS_MAX), 0);
+}
+
+static void test_reset_forgets(void)
+{
+    reset();
+    flush(s_screen, RECTS_MAX);
+    fb_tiles_reset(&s_tiles);
+    CHECK_EQ(flush(s_screen, RECTS_MAX), 1);
+    CHECK(rect_eq(&s_out[0], 0, 0, SCR_W - 1, SCR_H - 1));
+}
+
+/* Случайные изменения и области, выровненные и нет: фрейм-буфер всегда
+ * совпадает с кадром там, где прошла запись */
+static void test_random_frames(void)
+{
+    reset();
+    flush(s_screen, RECTS_MAX);
+    for (int it = 0; it < 5000; it++) {
+        int changes = (int)(rnd() % 4);
+        for (int c = 0; c < changes; c++) {
+            s_frame[rnd() % SCR_H][rnd() % SCR_W] = (uint16_t)rnd();
+        }
+        fb_rect_t area;
+        if (rnd() % 2) {
+            int32_t tx1 = (int32_t)(rnd() % 4), ty1 = (int32_t)(rnd() % 3);
+            area = (fb_rect_t){ tx1 * T, ty1 * T, (tx1 + (int32_t)(rnd() % (4 - tx1)) + 1) * T - 1,
+                                (ty1 + (int32_t)(rnd() % (3 - ty1)) + 1) * T - 1 };
+        } else {
+            area.x1 = (int32_t)(rnd() % SCR_W);
+            area.y1 = (int32_t)(rnd() % SCR_H);
+            area.x2 = area.x1 + (int32_t)(rnd() % (SCR_W - area.x1));
+            area.y2 = area.y1 + (int32_t)(rnd() % (SCR_H - area.y1));
+        }
+        /* Изменения вне области дойдут с одной из следующих */
+        flush(area, (size_t)(1 + rnd() % RECTS_MAX));
+        bool ok = fb_matches(area);
+        CHECK(ok);
+        if (!ok) {
+            fprintf(stderr, "iteration %d, area %d,%d..%d,%d\n", it, (int)area.x1, (int)area.y1,
+                    (int)area.x2, (int)area.y2);
+            return;
+        }
+    }
+    flush(s_screen, RECTS_MAX);
+    CHECK(fb_matches(s_screen));
+}
+
+int main(void)
+{
+    RUN(test_first_flush_writes_all);
+    RUN(test_unchanged_skipped);
+    RUN(test_single_tile);
+    RUN(test_runs_merge);
+    RUN(test_l_shape);
+    RUN(test_partial_tile);
+    RUN(test_overflow_whole_area);
+    RUN(test_reset_forgets);
+    RUN(test_random_frames);
+    return TEST_EXIT();
+}
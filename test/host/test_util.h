@@ -0,0 +1,34 @@
+/**
+ * @file test_util.h
+ * @brief Минимальные проверки для хостовых тестов: без фреймворка
+ */
+
+#pragma once
+
+#include <stdio.h>
+
+static int s_test_failures;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+        s_test_failures++; \
+    } \
+} while (0)
+
+#define CHECK_EQ(a, b) do { \
+    long long _a = (long long)(a), _b = (long long)(b); \
+    if (_a != _b) { \
+        fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", \
+                __FILE__, __LINE__, #a, #b, _a, _b); \
+        s_test_failures++; \
+    } \
+} while (0)
+
+#define RUN(test) do { \
+    int _before = s_test_failures; \
+    test(); \
+    printf("%s %s\n", s_test_failures == _before ? "PASS" : "FAIL", #test); \
+} while (0)
+
+#define TEST_EXIT() (s_test_failures ? 1 : 0)
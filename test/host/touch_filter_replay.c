@@ -0,0 +1,377 @@
+/**
+ * @file touch_filter_replay.c
+ * @brief Прогон трасс касаний через One-Euro: дрожание и запаздывание
+ *
+ *   touch_filter_replay [опции] trace.t1tr...   трассы (trace dump, touch_script.py)
+ *   touch_filter_replay [опции] --synthetic     встроенные сценарии с шумом
+ *
+ * Опции: --min-cutoff МГЦ*1000, --beta МГЦ*1000, --predict МС — как
+ * CONFIG_TOUCH_FILTER_*; по умолчанию значения Kconfig. --check — код
+ * выхода 1, если фильтр не снизил дрожание вдвое или запаздывание больше
+ * LAG_LIMIT_MS (так его гоняет ctest).
+ *
+ * Фильтруется первая точка кадра, как в задаче тача; штрих — кадры подряд
+ * с одним track id. Координаты GT911 берутся как есть (на хосте без
+ * калибровки они совпадают с экранными).
+ *
+ * Дрожание — RMS отклонения от скользящего среднего сырых точек (окно
+ * 2*WIN+1) там, где палец стоит: среднее первой и второй половины окна
+ * расходятся меньше чем на 1 px. Запаздывание — сдвиг во времени, при
+ * котором отфильтрованная траектория ближе всего к сырой там, где палец
+ * движется быстрее MOVE_MIN_PX_S; отрицательное — фильтр опережает
+ * (упреждение).
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "touch_filter.h"
+#include "touch_trace.h"
+
+/* Значения Kconfig по умолчанию и TOUCH_FILTER_D_CUTOFF_MHZ из touch.c */
+#define DEF_MIN_CUTOFF_MHZ  1000
+#define DEF_BETA_MHZ        10
+#define DEF_D_CUTOFF_MHZ    1000
+#define DEF_PREDICT_MS      8
+
+#define MAX_FRAMES          20000
+#define WIN                 4
+#define MOVE_MIN_PX_S       50.0
+#define LAG_SEARCH_MS       60
+#define LAG_LIMIT_MS        40.0
+
+typedef struct {
+    int64_t t_us;
+    int stroke;             /* -1 — палец не прижат */
+    double rx, ry;          /* сырая точка */
+    double fx, fy;          /* после фильтра */
+} sample_t;
+
+typedef struct {
+    double raw_jitter;
+    double out_jitter;
+    int still;
+    double lag_ms;
+    int moving;
+} result_t;
+
+static sample_t s_samples[MAX_FRAMES];
+static touch_trace_frame_t s_frames[MAX_FRAMES];
+
+/* ---------- Прогон фильтра ---------- */
+
+static int run_filter(const touch_trace_frame_t *frames, int n, const touch_filter_cfg_t *cfg)
+{
+    touch_filter_t f;
+    touch_filter_init(&f, cfg);
+    int stroke = -1;
+    int strokes = 0;
+    int prev_id = -1;
+    for (int i = 0; i < n; i++) {
+        sample_t *s = &s_samples[i];
+        s->t_us = frames[i].t_us;
+        if (frames[i].count == 0) {
+            s->stroke = -1;
+            prev_id = -1;
+            continue;
+        }
+        const touch_contact_t *c = &frames[i].contacts[0];
+        if (c->id != prev_id) {
+            touch_filter_reset(&f);
+            stroke = strokes++;
+            prev_id = c->id;
+        }
+        int16_t x = c->x;
+        int16_t y = c->y;
+        touch_filter_apply(&f, frames[i].t_us, &x, &y);
+        s->stroke = stroke;
+        s->rx = c->x;
+        s->ry = c->y;
+        s->fx = x;
+        s->fy = y;
+    }
+    return n;
+}
+
+/* ---------- Метрики ---------- */
+
+static bool window_ok(int n, int i, int half)
+{
+    if (i - half < 0 || i + half >= n) return false;
+    for (int k = i - half; k <= i + half; k++) {
+        if (s_samples[k].stroke != s_samples[i].stroke) return false;
+    }
+    return true;
+}
+
+static void window_mean(int from, int to, double *mx, double *my)
+{
+    double sx = 0, sy = 0;
+    for (int k = from; k <= to; k++) {
+        sx += s_samples[k].rx;
+        sy += s_samples[k].ry;
+    }
+    *mx = sx / (to - from + 1);
+    *my = sy / (to - from + 1);
+}
+
+/* Сырая точка штриха в момент t: линейно между отсчётами; false — вне штриха */
+static bool raw_at(int n, int near, int64_t t, double *x, double *y)
+{
+    int stroke = s_samples[near].stroke;
+    int k = near;
+    while (k > 0 && s_samples[k].t_us > t && s_samples[k - 1].stroke == stroke) k--;
+    while (k + 1 < n && s_samples[k + 1].t_us <= t && s_samples[k + 1].stroke == stroke) k++;
+    if (s_samples[k].t_us > t || k + 1 >= n || s_samples[k + 1].stroke != stroke) {
+        return false;
+    }
+    double u = (double)(t - s_samples[k].t_us) / (double)(s_samples[k + 1].t_us - s_samples[k].t_us);
+    *x = s_samples[k].rx + (s_samples[k + 1].rx - s_samples[k].rx) * u;
+    *y = s_samples[k].ry + (s_samples[k + 1].ry - s_samples[k].ry) * u;
+    return true;
+}
+
+static void measure(int n, result_t *r)
+{
+    double raw_sq = 0, out_sq = 0;
+    bool moving[MAX_FRAMES];
+    memset(r, 0, sizeof(*r));
+
+    for (int i = 0; i < n; i++) {
+        moving[i] = false;
+        if (s_samples[i].stroke < 0 || !window_ok(n, i, WIN)) continue;
+        double mx, my, ax, ay, bx, by;
+        window_mean(i - WIN, i + WIN, &mx, &my);
+        window_mean(i - WIN, i, &ax, &ay);
+        window_mean(i, i + WIN, &bx, &by);
+        double drift = hypot(bx - ax, by - ay);
+        double span_s = (double)(s_samples[i + WIN].t_us - s_samples[i - WIN].t_us) / 2e6;
+        if (drift < 1.0) {
+            raw_sq += pow(s_samples[i].rx - mx, 2) + pow(s_samples[i].ry - my, 2);
+            out_sq += pow(s_samples[i].fx - mx, 2) + pow(s_samples[i].fy - my, 2);
+            r->still++;
+        } else if (span_s > 0 && drift / span_s > MOVE_MIN_PX_S) {
+            moving[i] = true;
+            r->moving++;
+        }
+    }
+    if (r->still) {
+        r->raw_jitter = sqrt(raw_sq / r->still);
+        r->out_jitter = sqrt(out_sq / r->still);
+    }
+
+    double best = INFINITY;
+    for (int lag = -LAG_SEARCH_MS; lag <= LAG_SEARCH_MS; lag++) {
+        double err = 0;
+        int cnt = 0;
+        for (int i = 0; i < n; i++) {
+            double x, y;
+            if (!moving[i] || !raw_at(n, i, s_samples[i].t_us - (int64_t)lag * 1000, &x, &y)) continue;
+            err += pow(s_samples[i].fx - x, 2) + pow(s_samples[i].fy - y, 2);
+            cnt++;
+        }
+        if (cnt > r->moving / 2 && err / cnt < best) {
+            best = err / cnt;
+            r->lag_ms = lag;
+        }
+    }
+}
+
+/* ---------- Встроенные сценарии ---------- */
+
+static uint32_t s_rng = 1;
+
+/* Шум GT911 на неподвижном пальце: целые -amp..amp */
+static int noise(int amp)
+{
+    s_rng = s_rng * 1103515245u + 12345u;
+    return (int)((s_rng >> 16) % (uint32_t)(2 * amp + 1)) - amp;
+}
+
+typedef struct {
+    const char *name;
+    int ms;
+    int noise_px;
+    /* Положение в момент u = 0..1 */
+    void (*path)(double u, double *x, double *y);
+} scenario_t;
+
+static void path_still(double u, double *x, double *y)
+{
+    (void)u;
+    *x = 240;
+    *y = 240;
+}
+
+static void path_slow(double u, double *x, double *y)
+{
+    *x = 140 + 200 * u;     /* 100 px/s за 2 с */
+    *y = 240;
+}
+
+static void path_drag(double u, double *x, double *y)
+{
+    *x = 40 + 400 * u;      /* 500 px/s за 0.8 с */
+    *y = 100 + 200 * u;
+}
+
+static void path_flick(double u, double *x, double *y)
+{
+    *x = 60 + 360 * u;      /* 1440 px/s за 0.25 с */
+    *y = 400;
+}
+
+static void path_arc(double u, double *x, double *y)
+{
+    double a = 2 * M_PI * u;    /* окружность R 150 за 1 с, ~940 px/s */
+    *x = 240 + 150 * cos(a);
+    *y = 240 + 150 * sin(a);
+}
+
+static const scenario_t s_scenarios[] = {
+    { "still",        2000, 2, path_still },
+    { "drag_100px_s", 2000, 1, path_slow },
+    { "drag_500px_s",  800, 1, path_drag },
+    { "flick",         250, 1, path_flick },
+    { "arc_1rev_s",   1000, 1, path_arc },
+};
+
+#define SYNTH_PERIOD_US 10000
+
+static int synth_frames(const scenario_t *sc)
+{
+    int n = 0;
+    int steps = sc->ms * 1000 / SYNTH_PERIOD_US;
+    for (int i = 0; i <= steps && n < MAX_FRAMES - 1; i++) {
+        double x, y;
+        sc->path((double)i / steps, &x, &y);
+        touch_trace_frame_t *f = &s_frames[n++];
+        f->t_us = (int64_t)i * SYNTH_PERIOD_US;
+        f->count = 1;
+        f->contacts[0] = (touch_contact_t){
+            .x = (int16_t)lround(x) + (int16_t)noise(sc->noise_px),
+            .y = (int16_t)lround(y) + (int16_t)noise(sc->noise_px),
+            .size = 30,
+            .id = 0,
+        };
+    }
+    s_frames[n] = (touch_trace_frame_t){ .t_us = (int64_t)(steps + 1) * SYNTH_PERIOD_US, .count = 0 };
+    return n + 1;
+}
+
+/* ---------- Трассы из файла ---------- */
+
+static int load_trace(const char *path)
+{
+    FILE *fp = fopen(path, "rb");
+    if (!fp) {
+        perror(path);
+        return -1;
+    }
+    static uint8_t buf[1 << 20];
+    size_t len = fread(buf, 1, sizeof(buf), fp);
+    fclose(fp);
+    if (!touch_trace_check_header(buf, len)) {
+        fprintf(stderr, "%s: not a T1TR trace\n", path);
+        return -1;
+    }
+    size_t off = TOUCH_TRACE_HEADER_SIZE;
+    int n = 0;
+    int64_t t = 0;
+    while (off < len && n < MAX_FRAMES) {
+        size_t used = touch_trace_decode(buf + off, len - off, t, &s_frames[n]);
+        if (!used) break;
+        t = s_frames[n].t_us;
+        off += used;
+        n++;
+    }
+    return n;
+}
+
+/* ---------- main ---------- */
+
+static bool report(const char *name, int n, const touch_filter_cfg_t *cfg, bool check)
+{
+    result_t r;
+    run_filter(s_frames, n, cfg);
+    measure(n, &r);
+    printf("%-16s %6d", name, n);
+    if (r.still) {
+        printf("  %7.2f %7.2f", r.raw_jitter, r.out_jitter);
+    } else {
+        printf("  %7s %7s", "-", "-");
+    }
+    if (r.moving) {
+        printf("  %+7.0f\n", r.lag_ms);
+    } else {
+        printf("  %7s\n", "-");
+    }
+    bool ok = true;
+    if (check && r.still && r.raw_jitter > 0 && r.out_jitter > r.raw_jitter / 2) {
+        fprintf(stderr, "%s: jitter %.2f px, raw %.2f px\n", name, r.out_jitter, r.raw_jitter);
+        ok = false;
+    }
+    if (check && r.moving && fabs(r.lag_ms) > LAG_LIMIT_MS) {
+        fprintf(stderr, "%s: lag %.0f ms\n", name, r.lag_ms);
+        ok = false;
+    }
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    touch_filter_cfg_t cfg = {
+        .min_cutoff_mhz = DEF_MIN_CUTOFF_MHZ,
+        .beta_mhz = DEF_BETA_MHZ,
+        .d_cutoff_mhz = DEF_D_CUTOFF_MHZ,
+        .predict_us = DEF_PREDICT_MS * 1000,
+    };
+    bool synthetic = false;
+    bool check = false;
+    int first_file = argc;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--min-cutoff") && i + 1 < argc) {
+            cfg.min_cutoff_mhz = (uint32_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--beta") && i + 1 < argc) {
+            cfg.beta_mhz = (uint32_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--predict") && i + 1 < argc) {
+            cfg.predict_us = (uint32_t)atoi(argv[++i]) * 1000;
+        } else if (!strcmp(argv[i], "--synthetic")) {
+            synthetic = true;
+        } else if (!strcmp(argv[i], "--check")) {
+            check = true;
+        } else if (argv[i][0] == '-') {
+            fprintf(stderr, "usage: %s [--min-cutoff mHz] [--beta mHz] [--predict ms] [--check] "
+                    "(--synthetic | trace.t1tr...)\n", argv[0]);
+            return 2;
+        } else {
+            first_file = i;
+            break;
+        }
+    }
+    if (!synthetic && first_file == argc) {
+        synthetic = true;
+    }
+
+    printf("min_cutoff %u mHz, beta %u mHz, predict %u ms\n", (unsigned)cfg.min_cutoff_mhz,
+           (unsigned)cfg.beta_mhz, (unsigned)(cfg.predict_us / 1000));
+    printf("%-16s %6s  %7s %7s  %7s\n", "trace", "frames", "raw_px", "out_px", "lag_ms");
+    bool ok = true;
+    if (synthetic) {
+        for (size_t i = 0; i < sizeof(s_scenarios) / sizeof(s_scenarios[0]); i++) {
+            ok &= report(s_scenarios[i].name, synth_frames(&s_scenarios[i]), &cfg, check);
+        }
+    }
+    for (int i = first_file; i < argc; i++) {
+        int n = load_trace(argv[i]);
+        if (n < 0) {
+            ok = false;
+            continue;
+        }
+        ok &= report(argv[i], n, &cfg, check);
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,85 @@
+#!/usr/bin/env python3
+"""
+Сравнение двух отчётов ui_bench (main/ui_bench.h).
+
+    T1_BENCH=base.json build/Terminal1.elf      # до изменения
+    T1_BENCH=new.json build/Terminal1.elf       # после
+    python3 tools/bench_compare.py base.json new.json [--threshold 10]
+
+Можно подать и захват монитора с устройства после команды bench: берётся
+первый отчёт в тексте. Метрика, выросшая больше порога (в процентах), —
+регрессия, тогда код выхода 1. Отчёты с разной целью или режимом рендера
+между собой не сравнимы — об этом предупреждение.
+"""
+
+import json
+import sys
+
+# Все метрики — чем меньше, тем лучше
+METRICS = [
+    "render_us_mean",
+    "render_us_p99",
+    "render_us_max",
+    "inv_px_mean",
+    "inv_px_max",
+    "draw_tasks_mean",
+    "lv_heap_max_used",
+]
+# Единичный выброс max регрессией не считаем
+INFO_ONLY = {"render_us_max"}
+
+
+def load(path):
+    with open(path) as f:
+        text = f.read()
+    start = text.find('{"target"')
+    if start < 0:
+        sys.exit("%s: no bench report found" % path)
+    report, _ = json.JSONDecoder().raw_decode(text[start:])
+    return report
+
+
+def main():
+    args = sys.argv[1:]
+    threshold = 10.0
+    if "--threshold" in args:
+        i = args.index("--threshold")
+        threshold = float(args[i + 1])
+        del args[i:i + 2]
+    if len(args) != 2:
+        sys.exit("usage: bench_compare.py BASE NEW [--threshold PCT]")
+    base, new = load(args[0]), load(args[1])
+
+    for key in ("target", "render_mode"):
+        if base.get(key) != new.get(key):
+            print("warning: %s differs: %s vs %s" % (key, base.get(key), new.get(key)))
+
+    base_sc = {s["name"]: s for s in base["scenarios"]}
+    regressions = 0
+    print("%-12s %-16s %10s %10s %8s" % ("scenario", "metric", "base", "new", "delta"))
+    for sc in new["scenarios"]:
+        b = base_sc.get(sc["name"])
+        if b is None:
+            print("%-12s (new scenario)" % sc["name"])
+            continue
+        for m in METRICS:
+            old, cur = b.get(m, 0), sc.get(m, 0)
+            if old:
+                delta = 100.0 * (cur - old) / old
+            else:
+                delta = 0.0 if cur == 0 else float("inf")
+            mark = ""
+            if delta > threshold and m not in INFO_ONLY:
+                mark = "  REGRESSION"
+                regressions += 1
+            elif delta < -threshold:
+                mark = "  better"
+            print("%-12s %-16s %10d %10d %+7.1f%%%s" % (sc["name"], m, old, cur, delta, mark))
+
+    if regressions:
+        print("%d regression(s) over %.1f%%" % (regressions, threshold))
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
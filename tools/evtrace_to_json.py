@@ -0,0 +1,74 @@
+#!/usr/bin/env python3
+"""
+Перевод вывода «evtrace dump hex» в Chrome trace JSON.
+
+    python3 tools/evtrace_to_json.py uart.log > trace.json
+
+Строки лога без префиксов «task »/«ev » пропускаются, так что можно подать
+весь захват монитора. Результат открывается в chrome://tracing или
+ui.perfetto.dev. Формат записи — evtrace_rec_t из main/evtrace.h.
+"""
+
+import json
+import struct
+import sys
+
+# Порядок как в evtrace_id_t
+NAMES = [
+    "lv_timer_handler",
+    "async_call",
+    "render",
+    "flush_cb",
+    "flush_wait",
+    "flush_tiles",
+    "flush_done",
+    "gt911_read",
+    "update_labels",
+    "ui_timer",
+]
+
+REC = struct.Struct("<IIIHBB")
+INSTANT = 0xFFFFFFFF
+
+
+def convert(lines):
+    events = []
+    threads = {0: "ISR"}
+    for line in lines:
+        parts = line.strip().split(" ", 2)
+        if parts[0] == "task" and len(parts) == 3:
+            threads[int(parts[1])] = parts[2]
+        elif parts[0] == "ev" and len(parts) == 2 and len(parts[1]) == REC.size * 2:
+            ts, dur, task, ev_id, core, _ = REC.unpack(bytes.fromhex(parts[1]))
+            if ev_id >= len(NAMES):
+                continue
+            ev = {"name": NAMES[ev_id], "pid": 1, "tid": task, "ts": ts, "args": {"core": core}}
+            if dur == INSTANT:
+                ev.update(ph="i", s="t")
+            else:
+                ev.update(ph="X", dur=dur)
+            events.append(ev)
+
+    # 32-битные микросекунды: переход через ноль внутри дампа сдвигаем вперёд
+    if events:
+        first = min(e["ts"] for e in events)
+        last = max(e["ts"] for e in events)
+        if last - first > 1 << 31:
+            for e in events:
+                if e["ts"] < 1 << 31:
+                    e["ts"] += 1 << 32
+
+    events.sort(key=lambda e: e["ts"])
+    for tid, name in threads.items():
+        events.append({"name": "thread_name", "ph": "M", "pid": 1, "tid": tid, "args": {"name": name}})
+    return {"traceEvents": events, "displayTimeUnit": "ms"}
+
+
+def main():
+    src = open(sys.argv[1], errors="replace") if len(sys.argv) > 1 else sys.stdin
+    json.dump(convert(src), sys.stdout)
+    sys.stdout.write("\n")
+
+
+if __name__ == "__main__":
+    main()
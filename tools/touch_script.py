@@ -0,0 +1,126 @@
+#!/usr/bin/env python3
+"""
+Сценарий касаний в трассу GT911 (формат main/touch_trace.h).
+
+    python3 tools/touch_script.py drag.txt drag.t1tr
+    T1_TOUCH_TRACE=drag.t1tr build/Terminal1.elf
+
+Сценарий — по команде в строке, «#» — комментарий. Координаты — пиксели
+GT911 (на хосте без калибровки совпадают с экраном), время — мс. Пока палец
+прижат, кадры идут каждые 10 мс, как отчёты контроллера.
+
+    wait MS                       пауза без касаний
+    down X Y / move X Y / up      палец по шагам
+    hold MS                       держать палец на месте
+    tap X Y                       касание на 50 мс
+    drag X1 Y1 X2 Y2 MS           прямая от точки к точке
+    arc CX CY R A1 A2 MS          дуга: углы в градусах, 0 — вправо, по часовой
+"""
+
+import math
+import struct
+import sys
+
+PERIOD_MS = 10
+TAP_MS = 50
+TRACK_ID = 0
+SIZE = 30
+
+
+class Trace:
+    def __init__(self):
+        self.out = bytearray(b"T1TR" + bytes([1, 0, 0, 0]))
+        self.t_us = 0
+        self.prev_us = -1
+        self.pos = None
+
+    def frame(self, points):
+        # Два кадра в один момент контроллер не пришлёт
+        if self.t_us == self.prev_us:
+            self.step(PERIOD_MS)
+        dt = self.t_us - max(self.prev_us, 0)
+        self.prev_us = self.t_us
+        while True:
+            b = dt & 0x7F
+            dt >>= 7
+            self.out.append(b | (0x80 if dt else 0))
+            if not dt:
+                break
+        self.out.append(len(points))
+        for x, y in points:
+            self.out += struct.pack("<BHHH", TRACK_ID, int(round(x)), int(round(y)), SIZE)
+
+    def step(self, ms):
+        self.t_us += int(ms * 1000)
+
+    def down(self, x, y):
+        self.pos = (x, y)
+        self.frame([self.pos])
+
+    def move(self, x, y):
+        self.step(PERIOD_MS)
+        self.down(x, y)
+
+    def up(self):
+        self.step(PERIOD_MS)
+        self.pos = None
+        self.frame([])
+
+    def hold(self, ms):
+        for _ in range(int(ms) // PERIOD_MS):
+            self.move(*self.pos)
+
+    def path(self, fn, ms):
+        steps = max(1, int(ms) // PERIOD_MS)
+        self.down(*fn(0.0))
+        for i in range(1, steps + 1):
+            self.move(*fn(i / steps))
+        self.up()
+
+
+def run(lines):
+    tr = Trace()
+    for lineno, line in enumerate(lines, 1):
+        words = line.split("#", 1)[0].split()
+        if not words:
+            continue
+        cmd, args = words[0], [float(a) for a in words[1:]]
+        if cmd == "wait":
+            tr.step(args[0])
+        elif cmd == "down":
+            tr.down(*args)
+        elif cmd == "move":
+            tr.move(*args)
+        elif cmd == "up":
+            tr.up()
+        elif cmd == "hold":
+            tr.hold(args[0])
+        elif cmd == "tap":
+            tr.down(*args)
+            tr.hold(TAP_MS)
+            tr.up()
+        elif cmd == "drag":
+            x1, y1, x2, y2, ms = args
+            tr.path(lambda k: (x1 + (x2 - x1) * k, y1 + (y2 - y1) * k), ms)
+        elif cmd == "arc":
+            cx, cy, r, a1, a2, ms = args
+            def point(k):
+                a = math.radians(a1 + (a2 - a1) * k)
+                return cx + r * math.cos(a), cy + r * math.sin(a)
+            tr.path(point, ms)
+        else:
+            sys.exit("line %d: unknown command %r" % (lineno, cmd))
+    return bytes(tr.out)
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit("usage: touch_script.py SCRIPT OUT.t1tr")
+    with open(sys.argv[1]) as src:
+        data = run(src)
+    with open(sys.argv[2], "wb") as dst:
+        dst.write(data)
+
+
+if __name__ == "__main__":
+    main()